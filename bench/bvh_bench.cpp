@@ -0,0 +1,75 @@
+// Benchmark da BVH: renderiza cenas geradas com N esferas e compara o custo por amostra
+// entre a lista linear de objetos e a hierarquia de volumes envolventes.
+//
+// Uso: ./bench_bvh [largura altura amostras]
+
+#include "renderer.hpp"
+#include "objects/sphere.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// Gera N esferas pequenas espalhadas num cubo diante da câmera, mais um chão e a luz ambiente
+static SceneDescription generateScene(int n, int imgWidth, int imgHeight, int samplesPerPixel) {
+    SceneDescription scene;
+    scene.lookFrom = p3(0, 0, -250);
+    scene.lookAt = p3(0, 0, 0);
+    scene.vFov = 40;
+    scene.imgWidth = imgWidth;
+    scene.imgHeight = imgHeight;
+    scene.aspectRatio = double(imgWidth) / double(imgHeight);
+    scene.samplesPerPixel = samplesPerPixel;
+
+    scene.lights.push_back(Light(p3(0, 0, 0), make_shared<LightMaterial>(color(1, 1, 1), 1, 0, 0, true)));
+    scene.lights.push_back(Light(p3(60, 160, -200), make_shared<LightMaterial>(color(1, 1, 1), 1, 0, 0, true)));
+
+    TexturePtr white = make_shared<SolidColor>(color(0.9, 0.9, 0.9));
+    MaterialPtr diffuse = make_shared<GenericMaterial>(0.2, 0.6, 0.2, 10, 0.0, 0.0, 1.0, white);
+    MaterialPtr mirror = make_shared<GenericMaterial>(0.1, 0.2, 0.5, 100, 0.7, 0.0, 1.0, white);
+    scene.objectMaterials.push_back(diffuse);
+    scene.objectMaterials.push_back(mirror);
+
+    Random::seed(1234);
+    double radius = 60.0 / cbrt((double)n);
+    for(int i = 0; i < n; i++) {
+        p3 center = vec3::random(-80, 80);
+        scene.componentList.add(make_shared<Sphere>(center, radius, i % 4 == 0 ? mirror.get() : diffuse.get()));
+    }
+    scene.componentList.add(make_shared<Sphere>(p3(0, -10100, 0), 10000, diffuse.get()));
+    return scene;
+}
+
+static double timeRender(const SceneDescription& scene) {
+    auto start = chrono::steady_clock::now();
+    Renderer::render(scene, "/dev/null");
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    int imgWidth = 64, imgHeight = 48, samplesPerPixel = 2;
+    if(argc >= 4) {
+        imgWidth = atoi(argv[1]);
+        imgHeight = atoi(argv[2]);
+        samplesPerPixel = atoi(argv[3]);
+    }
+    double samples = double(imgWidth) * imgHeight * samplesPerPixel;
+
+    // Silencia o progresso do renderizador para não poluir a tabela
+    cerr.setstate(ios::failbit);
+
+    printf("%8s %18s %18s %10s\n", "esferas", "linear ns/amostra", "bvh ns/amostra", "aceleracao");
+    for(int n = 16; n <= 16384; n *= 4) {
+        SceneDescription scene = generateScene(n, imgWidth, imgHeight, samplesPerPixel);
+        double linear = timeRender(scene);
+
+        scene.componentList.build();
+        double bvh = timeRender(scene);
+
+        printf("%8d %18.0f %18.0f %9.1fx\n", n, 1e9 * linear / samples, 1e9 * bvh / samples, linear / bvh);
+        fflush(stdout);
+    }
+    return 0;
+}
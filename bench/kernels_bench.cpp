@@ -0,0 +1,279 @@
+// Microbenchmarks dos kernels de interseção, sombreamento e amostragem, com resultados estáveis e
+// legíveis por máquina para comparar compilações (outra precisão, outras flags, outro commit):
+//  - cada kernel percorre um lote fixo de entradas geradas com semente fixa (raios, vetores,
+//    pontos), grande o bastante para o compilador não calcular nada de antemão e pequeno o bastante
+//    para ficar no cache L1/L2; o gerador aleatório é ressemeado antes de cada medida;
+//  - as repetições são calibradas para que cada medida dure cerca de minSeconds; são feitas runs
+//    medidas e reportada a mediana, em ns/op e ops/s, com a dispersão (maior - menor) / mediana;
+//  - --json grava os resultados num arquivo; --compare lê um arquivo gravado antes (por outra
+//    compilação) e mostra a razão entre os tempos de cada kernel.
+//
+// Uso: ./bench_kernels [--json arquivo] [--compare arquivo] [--filter texto] [--runs n]
+// (rode da raiz do repositório, para os kernels de textura de imagem encontrarem textures/)
+
+#include "component_list.hpp"
+#include "camera.hpp"
+#include "objects/sphere.hpp"
+#include "objects/polyhedron.hpp"
+#include "materials/generic_material.hpp"
+#include "textures/solid_color.hpp"
+#include "textures/checker_texture.hpp"
+#include "textures/image_texture.hpp"
+#include "textures/image_texture_ps.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const int batch = 1024;          // entradas por kernel (potência de 2)
+static const double minSeconds = 0.05;  // duração de cada medida
+static volatile double sink;            // impede que o compilador descarte os resultados
+
+struct Result {
+    string name;
+    double nsPerOp;
+    double spread;
+    long ops;
+};
+
+// Segundos para executar ops operações (a entrada i usa o elemento i % batch do lote). O kernel é um
+// parâmetro de template, e não um std::function, para ser expandido no laço: a chamada indireta custaria
+// tanto quanto os kernels mais curtos (soma, produto escalar) e dominaria a medida.
+template<typename Op>
+static double timeOps(const Op& op, long ops) {
+    double sum = 0;
+    auto start = chrono::steady_clock::now();
+    for(long i = 0; i < ops; i++) {
+        sum += op(int(i & (batch - 1)));
+    }
+    auto end = chrono::steady_clock::now();
+    sink = sink + sum;
+    return chrono::duration<double>(end - start).count();
+}
+
+template<typename Op>
+static Result measure(const string& name, const Op& op, int runs) {
+    // Aquecimento e calibração: dobra as repetições até a medida passar de 1/10 do tempo pedido
+    long ops = batch;
+    double seconds;
+    Random::seed(42);
+    while((seconds = timeOps(op, ops)) < minSeconds / 10) ops *= 2;
+    ops = max(long(ops * minSeconds / seconds), long(batch));
+
+    vector<double> ns;
+    for(int r = 0; r < runs; r++) {
+        Random::seed(42);
+        ns.push_back(1e9 * timeOps(op, ops) / ops);
+    }
+    sort(ns.begin(), ns.end());
+    double median = ns[ns.size() / 2];
+    return Result{name, median, (ns.back() - ns.front()) / median, ops};
+}
+
+// Raios de origem aleatória numa casca em torno da origem, apontados para perto do centro:
+// cerca de metade atinge uma esfera de raio 1
+static vector<Ray> makeRays() {
+    vector<Ray> rays;
+    Random::seed(7);
+    for(int i = 0; i < batch; i++) {
+        p3 origin = 5 * vec3::randomUnitVector();
+        p3 target = vec3::random(-1.4, 1.4);
+        rays.push_back(Ray(origin, (target - origin).normalize()));
+    }
+    return rays;
+}
+
+// Lê os tempos de um arquivo gravado por writeJson (uma linha por kernel)
+static map<string, double> readJson(const string& path) {
+    map<string, double> times;
+    ifstream file(path);
+    string line;
+    while(getline(file, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t ns = line.find("\"ns_per_op\": ");
+        if(name == string::npos || ns == string::npos) continue;
+        name += 9;
+        times[line.substr(name, line.find('"', name) - name)] = atof(line.c_str() + ns + 13);
+    }
+    return times;
+}
+
+static bool writeJson(const string& path, const vector<Result>& results) {
+    FILE* file = fopen(path.c_str(), "w");
+    if(!file) {
+        fprintf(stderr, "Erro: Não foi possível criar o arquivo %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "{\n  \"precision\": \"%s\",\n  \"compiler\": \"%s\",\n  \"results\": [\n",
+            sizeof(real) == sizeof(float) ? "float" : "double", __VERSION__);
+    for(size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"ops_per_sec\": %.0f, \"spread\": %.4f, \"ops\": %ld}%s\n",
+                r.name.c_str(), r.nsPerOp, 1e9 / r.nsPerOp, r.spread, r.ops, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+    string jsonFile, compareFile, filter;
+    int runs = 7;
+    for(int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if(i + 1 >= argc) {
+            fprintf(stderr, "Valor esperado para %s\n", argv[i]);
+            return 1;
+        }
+        string value = argv[++i];
+        if(option == "--json") jsonFile = value;
+        else if(option == "--compare") compareFile = value;
+        else if(option == "--filter") filter = value;
+        else if(option == "--runs") runs = max(atoi(value.c_str()), 1);
+        else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i - 1]);
+            return 1;
+        }
+    }
+
+    // Entradas comuns
+    vector<Ray> rays = makeRays();
+    vector<vec3> a(batch), b(batch);
+    vector<vec2> uvs(batch);
+    vector<p3> points(batch);
+    Random::seed(11);
+    for(int i = 0; i < batch; i++) {
+        a[i] = vec3::random(-1, 1);
+        b[i] = vec3::random(-1, 1);
+        uvs[i] = vec2(randomDouble(), randomDouble());
+        points[i] = vec3::random(-2, 2);
+    }
+
+    TexturePtr white = make_shared<SolidColor>(color(0.9, 0.9, 0.9));
+    GenericMaterial diffuse(0.1, 0.7, 0.2, 10, 0.0, 0.0, 1.0, white);
+    GenericMaterial metal(0.1, 0.2, 0.5, 100, 1.0, 0.0, 1.0, white);
+    GenericMaterial glass(0.1, 0.1, 0.3, 1000, 0.0, 1.0, 1.5, white);
+
+    Sphere sphere(p3(0, 0, 0), 1.0, &diffuse);
+
+    // Cubo de lado 2 e octaedro (8 faces) centrados na origem
+    Polyhedron cube(&diffuse);
+    for(int axis = 0; axis < 3; axis++) {
+        for(int sign = -1; sign <= 1; sign += 2) {
+            real n[3] = {0, 0, 0};
+            n[axis] = sign;
+            cube.addFace(Plane(n[0], n[1], n[2], -1));
+        }
+    }
+    Polyhedron octahedron(&diffuse);
+    for(int i = 0; i < 8; i++) {
+        octahedron.addFace(Plane(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1, -1.5));
+    }
+
+    // BVH com 4096 esferas pequenas espalhadas num cubo de lado 4
+    ComponentList world;
+    Random::seed(3);
+    for(int i = 0; i < 4096; i++) {
+        world.add(make_shared<Sphere>(vec3::random(-2, 2), 0.05, &diffuse));
+    }
+    world.build();
+
+    // Registros de acerto reais na esfera, para o espalhamento
+    vector<Ray> hitRays;
+    vector<HitRecord> hits;
+    hitRays.reserve(batch);
+    hits.reserve(batch);
+    for(const Ray& r : rays) {
+        HitRecord rec;
+        if(sphere.hit(r, 0.001, infinity, rec)) {
+            hitRays.push_back(r);
+            hits.push_back(rec);
+        }
+    }
+    for(size_t k = 0, n = hits.size(); (int)hits.size() < batch; k++) {
+        hits.push_back(hits[k % n]);
+        hitRays.push_back(hitRays[k % n]);
+    }
+
+    Camera pinhole(p3(13, 2, 3), p3(0, 0, 0), vec3(0, 1, 0), 50, 4.0 / 3.0, 0, 10);
+    Camera thinLens(p3(13, 2, 3), p3(0, 0, 0), vec3(0, 1, 0), 50, 4.0 / 3.0, 0.5, 10);
+
+    CheckerTexture checker(color(0.9, 0.9, 0.9), color(0.1, 0.1, 0.1));
+    checker.setSize(0.5);
+
+    // As mensagens de carga das texturas vão para cout
+    cout.setstate(ios::failbit);
+    ImageTexture image("textures/rainbow1.ppm");
+    ImageTexturePs imagePs("textures/rainbow1.ppm", vec4(0.25, 0, 0, 0.5), vec4(0, 0.25, 0, 0.5));
+    bool haveImage = TextureCache::imageCount() > 0;
+    cout.clear();
+    Footprint sharp;
+    Footprint blurry;
+    blurry.width = 0.05;
+    blurry.uvPerUnit = 0.5;
+
+    auto rgb = [](const color& c) { return double(c.x() + c.y() + c.z()); };
+
+    if(!haveImage) {
+        fprintf(stderr, "Aviso: textures/rainbow1.ppm não encontrada; kernels de textura de imagem ignorados\n");
+    }
+
+    map<string, double> previous;
+    if(!compareFile.empty()) {
+        previous = readJson(compareFile);
+        if(previous.empty()) {
+            fprintf(stderr, "Erro: nenhum resultado em %s\n", compareFile.c_str());
+            return 1;
+        }
+    }
+
+    printf("precisao: %s, %d medidas por kernel (mediana)\n", sizeof(real) == sizeof(float) ? "float" : "double", runs);
+    printf("%-28s %10s %14s %9s", "kernel", "ns/op", "ops/s", "disp");
+    if(!previous.empty()) printf(" %10s %8s", "antes", "razao");
+    printf("\n");
+
+    // Mede e mostra um kernel; cada chamada instancia measure com o próprio lambda
+    vector<Result> results;
+    auto run = [&](const string& name, const auto& op) {
+        if(!filter.empty() && name.find(filter) == string::npos) return;
+        Result r = measure(name, op, runs);
+        results.push_back(r);
+        printf("%-28s %10.2f %14.0f %8.1f%%", r.name.c_str(), r.nsPerOp, 1e9 / r.nsPerOp, 100 * r.spread);
+        auto it = previous.find(r.name);
+        if(it != previous.end()) printf(" %10.2f %7.2fx", it->second, it->second / r.nsPerOp);
+        printf("\n");
+        fflush(stdout);
+    };
+
+    run("vec3_add", [&](int i) { return double((a[i] + b[i]).x()); });
+    run("vec3_dot", [&](int i) { return double(a[i].dot(b[i])); });
+    run("vec3_cross", [&](int i) { return double(vec3::cross(a[i], b[i]).y()); });
+    run("vec3_normalize", [&](int i) { return double(a[i].normalize().z()); });
+    run("vec3_reflect", [&](int i) { return double(a[i].reflect(b[i]).x()); });
+    run("sphere_hit", [&](int i) { HitRecord rec; return sphere.hit(rays[i], 0.001, infinity, rec) ? double(rec.t) : 0.0; });
+    run("sphere_occluded", [&](int i) { return sphere.occluded(rays[i], 0.001, infinity) ? 1.0 : 0.0; });
+    run("polyhedron_hit_cube", [&](int i) { HitRecord rec; return cube.hit(rays[i], 0.001, infinity, rec) ? double(rec.t) : 0.0; });
+    run("polyhedron_hit_octahedron", [&](int i) { HitRecord rec; return octahedron.hit(rays[i], 0.001, infinity, rec) ? double(rec.t) : 0.0; });
+    run("componentlist_hit_4096", [&](int i) { HitRecord rec; return world.hit(rays[i], 0.001, infinity, rec, false) ? double(rec.t) : 0.0; });
+    run("scatter_lambertian", [&](int i) { color att; Ray out; bool light; diffuse.scatter(hitRays[i], hits[i], att, out, light); return double(out.dir.x()); });
+    run("scatter_metal", [&](int i) { color att; Ray out; bool light; metal.scatter(hitRays[i], hits[i], att, out, light); return double(out.dir.x()); });
+    run("scatter_dielectric", [&](int i) { color att; Ray out; bool light; glass.scatter(hitRays[i], hits[i], att, out, light); return double(out.dir.x()); });
+    run("camera_getray_pinhole", [&](int i) { return double(pinhole.getRay(uvs[i].u(), uvs[i].v()).dir.x()); });
+    run("camera_getray_thinlens", [&](int i) { return double(thinLens.getRay(uvs[i].u(), uvs[i].v()).dir.x()); });
+    run("texture_solid", [&](int i) { return rgb(white->value(uvs[i], points[i], sharp)); });
+    run("texture_checker", [&](int i) { return rgb(checker.value(uvs[i], points[i], sharp)); });
+    if(haveImage) {
+        run("texture_image_sharp", [&](int i) { return rgb(image.value(uvs[i], points[i], sharp)); });
+        run("texture_image_filtered", [&](int i) { return rgb(image.value(uvs[i], points[i], blurry)); });
+        run("texture_image_ps", [&](int i) { return rgb(imagePs.value(uvs[i], points[i], blurry)); });
+    }
+
+    if(!jsonFile.empty() && !writeJson(jsonFile, results)) return 1;
+    return 0;
+}
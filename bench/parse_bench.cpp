@@ -0,0 +1,166 @@
+// Benchmark da leitura de cenas (ver TextReader em text_reader.hpp). Gera um arquivo de cena grande,
+// com esferas e poliedros, e mede:
+//  1. só a tokenização e conversão dos números, com o método antigo (getline + split + stod, copiado
+//     abaixo) e com o arquivo mapeado em memória + std::from_chars;
+//  2. InputProcessor::processFile completo, que inclui criar os objetos e construir a BVH, a partir
+//     do arquivo de texto e dos arquivos binários de SceneFile com e sem a topologia da BVH gravada.
+// Cada medida é a melhor de algumas repetições, para descontar o ruído da máquina.
+//
+// Uso: ./bench_parse [esferas poliedros]
+
+#include "input_processor.hpp"
+#include "text_reader.hpp"
+#include "scene_file.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+static const int repetitions = 5;
+
+static void writeScene(const string& path, int spheres, int polyhedra) {
+    ofstream file(path);
+    Random::seed(42);
+    file << "0 40 -220\n0 20 -100\n0 1 0\n40\n";
+    file << "2\n0 0 0 1 1 1 1 0 0\n60.0 160.0 -200.0 1 1 1 1 0 0\n";
+    file << "2\nsolid 0.8 0.2 0.1\nchecker .08 .25 .20 .93 .83 .82 40\n";
+    file << "2\n0.11 0.11 0.30 1000 0.7 0 0\n0.30 0.40 0.00 1 0.3 0 0 0.05\n";
+    file << spheres + polyhedra << "\n";
+    for(int i = 0; i < spheres; i++) {
+        file << i % 2 << " " << (i / 2) % 2 << " sphere " << randomDouble(-500, 500) << " "
+             << randomDouble(-500, 500) << " " << randomDouble(-500, 500) << " " << randomDouble(0.5, 5) << "\n";
+    }
+    // Cubos: seis planos ax + by + cz + d = 0 em torno de um centro aleatório
+    for(int i = 0; i < polyhedra; i++) {
+        double c[3] = {randomDouble(-500, 500), randomDouble(-500, 500), randomDouble(-500, 500)};
+        double half = randomDouble(0.5, 5);
+        file << i % 2 << " " << (i / 2) % 2 << " polyhedron 6\n";
+        for(int axis = 0; axis < 3; axis++) {
+            for(int sign = -1; sign <= 1; sign += 2) {
+                double n[3] = {0, 0, 0};
+                n[axis] = sign;
+                file << n[0] << " " << n[1] << " " << n[2] << " " << -(sign * c[axis] + half) << "\n";
+            }
+        }
+    }
+    file << "1.5 200\n";
+}
+
+static bool isNumberStart(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+}
+
+// Método antigo: uma string por linha, um vector<string> por linha e stod por token
+static double legacyTokenize(const string& path, size_t& tokens) {
+    ifstream file(path);
+    string line;
+    double sum = 0;
+    while(getline(file, line)) {
+        vector<string> words = split(line);
+        for(const string& w : words) {
+            if(isNumberStart(w[0])) sum += stod(w);
+            tokens++;
+        }
+    }
+    return sum;
+}
+
+static double mappedTokenize(const string& path, size_t& tokens) {
+    MappedFile file;
+    file.open(path);
+    TextReader reader(file.contents());
+    double sum = 0;
+    while(reader.nextLine()) {
+        while(reader.hasMore()) {
+            // Olha o token sem consumi-lo: number() converte o mesmo token que word() devolveria
+            TextReader peek = reader;
+            string_view w = peek.word();
+            if(isNumberStart(w[0])) sum += reader.number();
+            else reader = peek;
+            tokens++;
+        }
+    }
+    return sum;
+}
+
+// Melhor tempo (s) de algumas repetições
+template<typename F>
+static double best(F f) {
+    double result = 1e30;
+    for(int r = 0; r < repetitions; r++) {
+        auto start = chrono::steady_clock::now();
+        f();
+        auto end = chrono::steady_clock::now();
+        result = min(result, chrono::duration<double>(end - start).count());
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int spheres = 200000, polyhedra = 50000;
+    if(argc >= 3) {
+        spheres = atoi(argv[1]);
+        polyhedra = atoi(argv[2]);
+    }
+
+    string path = (filesystem::temp_directory_path() / "bench_parse_scene.txt").string();
+    writeScene(path, spheres, polyhedra);
+    double megabytes = filesystem::file_size(path) / 1e6;
+    int objects = spheres + polyhedra;
+    printf("cena: %d esferas, %d poliedros, %.1f MB\n\n", spheres, polyhedra, megabytes);
+
+    double sums[2] = {0, 0};
+    size_t tokens[2] = {0, 0};
+    double legacy = best([&] { tokens[0] = 0; sums[0] = legacyTokenize(path, tokens[0]); });
+    double mapped = best([&] { tokens[1] = 0; sums[1] = mappedTokenize(path, tokens[1]); });
+    if(sums[0] != sums[1] || tokens[0] != tokens[1]) {
+        fprintf(stderr, "Erro: os dois métodos leram valores diferentes (%g, %g)\n", sums[0], sums[1]);
+        return 1;
+    }
+
+    printf("%-28s %10s %10s %14s\n", "tokenizacao", "ms", "MB/s", "tokens/s");
+    printf("%-28s %10.1f %10.1f %14.0f\n", "getline + split + stod", 1e3 * legacy, megabytes / legacy, tokens[0] / legacy);
+    printf("%-28s %10.1f %10.1f %14.0f\n", "mmap + from_chars", 1e3 * mapped, megabytes / mapped, tokens[1] / mapped);
+    printf("ganho: %.2fx\n\n", legacy / mapped);
+
+    // Os mesmos registros gravados no formato binário, com e sem a BVH
+    string binaryPath = path + ".rtscene", binaryNoBVHPath = path + ".nobvh.rtscene";
+    {
+        MappedFile file;
+        SceneData data;
+        if(!file.open(path) || !InputProcessor::parseFile(file.contents(), path, data)) {
+            fprintf(stderr, "Erro: Não foi possível ler %s\n", path.c_str());
+            return 1;
+        }
+        SceneDescription scene;
+        SceneFile::instantiate(data.view(), scene);
+        SceneFile::write(binaryPath, data, &scene.componentList);
+        SceneFile::write(binaryNoBVHPath, data, nullptr);
+    }
+
+    const string files[3] = {path, binaryNoBVHPath, binaryPath};
+    const char* names[3] = {"texto", "binario sem BVH", "binario com BVH"};
+    printf("%-28s %10s %10s %14s\n", "processFile (com BVH)", "ms", "MB/s", "objetos/s");
+    for(int f = 0; f < 3; f++) {
+        size_t read = 0;
+        double full = best([&] {
+            SceneDescription scene;
+            read = InputProcessor::processFile(files[f], scene) ? scene.componentList.objects.size() : 0;
+        });
+        double size = filesystem::file_size(files[f]) / 1e6;
+        printf("%-28s %10.1f %10.1f %14.0f\n", names[f], 1e3 * full, size / full, read / full);
+        if((int)read != objects) {
+            fprintf(stderr, "Erro: %zu objetos lidos de %s, %d esperados\n", read, files[f].c_str(), objects);
+            return 1;
+        }
+    }
+
+    filesystem::remove(binaryPath);
+    filesystem::remove(binaryNoBVHPath);
+    filesystem::remove(path);
+    return 0;
+}
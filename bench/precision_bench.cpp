@@ -0,0 +1,160 @@
+// Benchmark de precisão: renderiza as cenas de inputs/ com o tipo real desta compilação
+// (bench_precision_double ou bench_precision_float, ver real.hpp) e mede amostras primárias por
+// segundo. Cada imagem é gravada em PFM na pasta de saída; quando a imagem da outra precisão já
+// está lá, mostra o PSNR entre as duas. A versão double também renderiza cada cena com outra
+// semente e mostra esse PSNR como referência do ruído de amostragem: as tolerâncias de float
+// estão adequadas quando o PSNR float x double fica próximo dessa referência.
+//
+// O piso de cada cena é o PSNR entre as duas sementes menos psnrMargin dB. Com as tolerâncias de
+// real.hpp o PSNR float x double fica no máximo uns 3 dB abaixo da referência (as duas precisões
+// seguem caminhos diferentes depois do primeiro desvio, então a diferença é ruído de amostragem); um
+// rayEpsilon pequeno demais para float (auto-interseção) derruba o PSNR em 6 a 12 dB. Quando as duas
+// imagens e a referência estão na pasta, uma cena abaixo do piso é uma falha e o código de saída é 1.
+// A versão float sem as imagens da versão double sai com código 2.
+//
+// Uso: ./bench_precision_double [largura altura amostras] [pasta]
+//      ./bench_precision_float  [largura altura amostras] [pasta]
+
+#include "renderer.hpp"
+#include "input_processor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+#ifdef RT_SINGLE_PRECISION
+static const char* precisionName = "float";
+static const char* otherPrecisionName = "double";
+#else
+static const char* precisionName = "double";
+static const char* otherPrecisionName = "float";
+#endif
+
+// Quanto o PSNR float x double pode ficar abaixo do PSNR entre duas sementes
+static const double psnrMargin = 4.0;
+
+// Lê um PFM gravado pelo PfmWriter (mesma ordem de bytes da máquina)
+static bool readPfm(const string& path, vector<float>& pixels, int& width, int& height) {
+    ifstream file(path, ios::binary);
+    string magic;
+    double scale;
+    if(!(file >> magic >> width >> height >> scale) || magic != "PF") return false;
+    file.get();
+    pixels.resize(size_t(width) * height * 3);
+    file.read((char*)pixels.data(), pixels.size() * sizeof(float));
+    return bool(file);
+}
+
+// PSNR em dB entre duas imagens, com os canais limitados a [0, 1]
+static double psnr(const string& pathA, const string& pathB) {
+    vector<float> a, b;
+    int wa, ha, wb, hb;
+    if(!readPfm(pathA, a, wa, ha) || !readPfm(pathB, b, wb, hb) || wa != wb || ha != hb) return NAN;
+
+    double mse = 0;
+    for(size_t i = 0; i < a.size(); i++) {
+        double d = clamp((double)a[i], 0.0, 1.0) - clamp((double)b[i], 0.0, 1.0);
+        mse += d * d;
+    }
+    mse /= a.size();
+    return mse > 0 ? 10 * log10(1.0 / mse) : INFINITY;
+}
+
+static double timeRender(const SceneDescription& scene, const string& path, ThreadPool& pool) {
+    auto start = chrono::steady_clock::now();
+    Renderer::render(scene, path, pool);
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    int imgWidth = 160, imgHeight = 120, samplesPerPixel = 32;
+    string outDir = "bench_precision";
+    if(argc >= 4) {
+        imgWidth = atoi(argv[1]);
+        imgHeight = atoi(argv[2]);
+        samplesPerPixel = atoi(argv[3]);
+    }
+    if(argc == 2 || argc >= 5) outDir = argv[argc - 1];
+    filesystem::create_directories(outDir);
+
+    vector<string> inputs;
+    for(const auto& entry : filesystem::directory_iterator("inputs")) {
+        if(entry.path().extension() == ".txt") inputs.push_back(entry.path().string());
+    }
+    sort(inputs.begin(), inputs.end());
+
+    double samples = double(imgWidth) * imgHeight * samplesPerPixel;
+    ThreadPool pool;
+
+    printf("precisao: %s (sizeof(real) = %zu), %dx%d, %d amostras\n", precisionName, sizeof(real), imgWidth, imgHeight, samplesPerPixel);
+    printf("%-36s %14s %14s %16s %8s\n", "cena", "amostras/s", "PSNR x outra", "PSNR x semente", "piso");
+
+    int failures = 0, unchecked = 0;
+
+    for(const string& input : inputs) {
+        // Silencia as mensagens da leitura e o progresso do renderizador para não poluir a tabela
+        cout.setstate(ios::failbit);
+        cerr.setstate(ios::failbit);
+
+        SceneDescription scene;
+        if(!InputProcessor::processFile(input, scene)) {
+            cerr.clear();
+            cerr << "Erro: Não foi possível ler " << input << endl;
+            return 2;
+        }
+        scene.imgWidth = imgWidth;
+        scene.imgHeight = imgHeight;
+        scene.aspectRatio = double(imgWidth) / double(imgHeight);
+        scene.samplesPerPixel = samplesPerPixel;
+        scene.outputFormat = ImageFormat::PFM;
+
+        string name = filesystem::path(input).stem().string();
+        string path = outDir + "/" + name + "." + precisionName + ".pfm";
+        string otherPath = outDir + "/" + name + "." + otherPrecisionName + ".pfm";
+        double seconds = timeRender(scene, path, pool);
+
+        // A referência de ruído é sempre entre as duas imagens double
+        string seedPath = outDir + "/" + name + ".seed1.pfm";
+#ifdef RT_SINGLE_PRECISION
+        double seedPsnr = psnr(otherPath, seedPath);
+#else
+        scene.seed = 1;
+        timeRender(scene, seedPath, pool);
+        double seedPsnr = psnr(path, seedPath);
+#endif
+
+        cout.clear();
+        cerr.clear();
+
+        double otherPsnr = filesystem::exists(otherPath) ? psnr(path, otherPath) : NAN;
+        double minPsnr = seedPsnr - psnrMargin;
+        const char* verdict = "";
+        if(std::isnan(otherPsnr) || std::isnan(minPsnr)) {
+            unchecked++;
+        } else if(otherPsnr < minPsnr) {
+            verdict = "  FALHOU";
+            failures++;
+        }
+        printf("%-36s %14.0f %14.2f %16.2f %8.2f%s\n", name.c_str(), samples / seconds, otherPsnr, seedPsnr, minPsnr, verdict);
+        fflush(stdout);
+    }
+
+    if(failures > 0) {
+        fprintf(stderr, "%d cena(s) abaixo do piso de PSNR\n", failures);
+        return 1;
+    }
+#ifdef RT_SINGLE_PRECISION
+    if(unchecked > 0) {
+        fprintf(stderr, "%d cena(s) sem as imagens double em %s: rode bench_precision_double antes, com a mesma pasta e os mesmos parâmetros\n",
+                unchecked, outDir.c_str());
+        return 2;
+    }
+#endif
+    return 0;
+}
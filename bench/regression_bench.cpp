@@ -0,0 +1,338 @@
+// Verificação de desempenho de ponta a ponta: renderiza cada cena de inputs/ com resolução, amostras e
+// semente fixas e mede o tempo de renderização (o menor de --repeat execuções), os raios traçados por
+// segundo e o pico de memória residente. Cada cena roda num processo filho (fork), então o pico de
+// memória medido (wait4) é o dela e não o das cenas anteriores.
+//
+// As imagens são gravadas em PFM e comparadas com as imagens de referência (RMSE e PSNR, com os canais
+// limitados a [0, 1]); com a mesma compilação elas são idênticas, e a tolerância (--min-psnr) cobre
+// outra precisão ou outro compilador. Os resultados são comparados com uma baseline gravada antes por
+// --save: tempo ou memória acima da tolerância, ou imagem abaixo do PSNR mínimo, são regressões, e o
+// código de saída é 1 se houver alguma. Com --baseline, não ter com o que comparar é um erro (código 2):
+// uma baseline que não pode ser lida ou foi gravada com outras configurações, uma cena sem imagem de
+// referência ou uma cena que não está na baseline. Sem --baseline, a falta da referência só é informada.
+//
+// Uso: ./bench_regression [--baseline arquivo.json] [--save arquivo.json] [--references pasta]
+//                         [--update-references] [--width n] [--height n] [--spp n] [--seed n]
+//                         [--threads n] [--repeat n] [--time-tolerance f] [--memory-tolerance f]
+//                         [--min-psnr dB]
+// (rode da raiz do repositório, por causa dos caminhos das texturas nas cenas)
+
+#include "renderer.hpp"
+#include "input_processor.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct Settings {
+    int width = 160, height = 120, samplesPerPixel = 16, threads = 0, repeat = 3;
+    uint64_t seed = 0;
+    double timeTolerance = 0.15;   // aumento relativo do tempo aceito
+    double memoryTolerance = 0.20; // aumento relativo do pico de memória aceito
+    double minPsnr = 40;
+};
+
+struct SceneResult {
+    string name;
+    double seconds = NAN;
+    double rays = NAN;
+    double peakRssKb = NAN;
+    double rmse = NAN;
+    double psnr = NAN;
+};
+
+// O que o processo filho devolve pelo pipe
+struct ChildReport {
+    double seconds;
+    uint64_t rays;
+    bool ok;
+};
+
+static const char* precisionName = sizeof(real) == sizeof(float) ? "float" : "double";
+
+// Lê um PFM gravado pelo PfmWriter (mesma ordem de bytes da máquina)
+static bool readPfm(const string& path, vector<float>& pixels, int& width, int& height) {
+    ifstream file(path, ios::binary);
+    string magic;
+    double scale;
+    if(!(file >> magic >> width >> height >> scale) || magic != "PF") return false;
+    file.get();
+    pixels.resize(size_t(width) * height * 3);
+    file.read((char*)pixels.data(), pixels.size() * sizeof(float));
+    return bool(file);
+}
+
+// RMSE entre duas imagens, com os canais limitados a [0, 1]; NAN se não puderem ser comparadas
+static double rmse(const string& pathA, const string& pathB) {
+    vector<float> a, b;
+    int wa, ha, wb, hb;
+    if(!readPfm(pathA, a, wa, ha) || !readPfm(pathB, b, wb, hb) || wa != wb || ha != hb) return NAN;
+
+    double mse = 0;
+    for(size_t i = 0; i < a.size(); i++) {
+        double d = clamp((double)a[i], 0.0, 1.0) - clamp((double)b[i], 0.0, 1.0);
+        mse += d * d;
+    }
+    return sqrt(mse / a.size());
+}
+
+// Renderiza a cena num processo filho; preenche tempo, raios e pico de memória
+static bool renderScene(const string& input, const string& output, const Settings& settings, SceneResult& result) {
+    int channel[2];
+    if(pipe(channel) != 0) return false;
+
+    pid_t pid = fork();
+    if(pid < 0) return false;
+    if(pid == 0) {
+        close(channel[0]);
+        // Silencia as mensagens da leitura e o progresso do renderizador
+        cout.setstate(ios::failbit);
+        cerr.setstate(ios::failbit);
+
+        SceneDescription scene;
+        if(!InputProcessor::processFile(input, scene)) _exit(1);
+        scene.imgWidth = settings.width;
+        scene.imgHeight = settings.height;
+        scene.aspectRatio = double(settings.width) / double(settings.height);
+        scene.samplesPerPixel = settings.samplesPerPixel;
+        scene.seed = settings.seed;
+        scene.threads = settings.threads;
+        scene.outputFormat = ImageFormat::PFM;
+        scene.showProgress = false;
+
+        ChildReport report = {INFINITY, 0, true};
+        ThreadPool pool(settings.threads);
+        for(int r = 0; r < settings.repeat && report.ok; r++) {
+            uint64_t raysBefore = Renderer::raysTraced();
+            auto start = chrono::steady_clock::now();
+            report.ok = Renderer::render(scene, output, pool);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            report.seconds = min(report.seconds, seconds);
+            report.rays = Renderer::raysTraced() - raysBefore;
+        }
+        ssize_t written = write(channel[1], &report, sizeof(report));
+        _exit(written == sizeof(report) && report.ok ? 0 : 1);
+    }
+
+    close(channel[1]);
+    ChildReport report;
+    bool received = read(channel[0], &report, sizeof(report)) == sizeof(report);
+    close(channel[0]);
+
+    int status;
+    struct rusage usage;
+    if(wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !received) {
+        return false;
+    }
+    result.seconds = report.seconds;
+    result.rays = report.rays;
+    result.peakRssKb = usage.ru_maxrss; // KiB no Linux
+    return true;
+}
+
+// Valor numérico de "key": numa linha do JSON gravado por writeJson (NAN se não estiver lá)
+static double field(const string& line, const string& key) {
+    size_t at = line.find("\"" + key + "\": ");
+    if(at == string::npos) return NAN;
+    string value = line.substr(at + key.size() + 4);
+    return value.compare(0, 4, "null") == 0 ? NAN : atof(value.c_str());
+}
+
+static string textField(const string& line, const string& key) {
+    size_t at = line.find("\"" + key + "\": \"");
+    if(at == string::npos) return "";
+    at += key.size() + 5;
+    return line.substr(at, line.find('"', at) - at);
+}
+
+static bool readJson(const string& path, Settings& settings, string& precision, map<string, SceneResult>& scenes) {
+    ifstream file(path);
+    if(!file.is_open()) return false;
+    string line;
+    while(getline(file, line)) {
+        if(line.find("\"settings\"") != string::npos) {
+            settings.width = field(line, "width");
+            settings.height = field(line, "height");
+            settings.samplesPerPixel = field(line, "spp");
+            settings.seed = field(line, "seed");
+            precision = textField(line, "precision");
+        }
+        string name = textField(line, "name");
+        if(name.empty()) continue;
+        SceneResult& r = scenes[name];
+        r.name = name;
+        r.seconds = field(line, "seconds");
+        r.rays = field(line, "rays");
+        r.peakRssKb = field(line, "peak_rss_kb");
+        r.rmse = field(line, "rmse");
+        r.psnr = field(line, "psnr");
+    }
+    return true;
+}
+
+static string number(double value, const char* format) {
+    if(std::isnan(value)) return "null";
+    if(std::isinf(value)) return "1e999";
+    char text[64];
+    snprintf(text, sizeof(text), format, value);
+    return text;
+}
+
+static bool writeJson(const string& path, const Settings& settings, const vector<SceneResult>& results) {
+    FILE* file = fopen(path.c_str(), "w");
+    if(!file) {
+        fprintf(stderr, "Erro: Não foi possível criar o arquivo %s\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "{\n  \"settings\": {\"width\": %d, \"height\": %d, \"spp\": %d, \"seed\": %llu, \"precision\": \"%s\"},\n",
+            settings.width, settings.height, settings.samplesPerPixel, (unsigned long long)settings.seed, precisionName);
+    fprintf(file, "  \"scenes\": [\n");
+    for(size_t i = 0; i < results.size(); i++) {
+        const SceneResult& r = results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"seconds\": %s, \"rays\": %s, \"rays_per_sec\": %s, \"peak_rss_kb\": %s, \"rmse\": %s, \"psnr\": %s}%s\n",
+                r.name.c_str(), number(r.seconds, "%.4f").c_str(), number(r.rays, "%.0f").c_str(),
+                number(r.rays / r.seconds, "%.0f").c_str(), number(r.peakRssKb, "%.0f").c_str(),
+                number(r.rmse, "%.6g").c_str(), number(r.psnr, "%.2f").c_str(), i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+    Settings settings;
+    string baselineFile, saveFile, referenceDir = "bench/references", outDir = "regression_out";
+    bool updateReferences = false;
+    for(int i = 1; i < argc; i++) {
+        string option = argv[i];
+        if(option == "--update-references") {
+            updateReferences = true;
+            continue;
+        }
+        if(i + 1 >= argc) {
+            fprintf(stderr, "Valor esperado para %s\n", argv[i]);
+            return 2;
+        }
+        string value = argv[++i];
+        if(option == "--baseline") baselineFile = value;
+        else if(option == "--save") saveFile = value;
+        else if(option == "--references") referenceDir = value;
+        else if(option == "--width") settings.width = atoi(value.c_str());
+        else if(option == "--height") settings.height = atoi(value.c_str());
+        else if(option == "--spp") settings.samplesPerPixel = atoi(value.c_str());
+        else if(option == "--seed") settings.seed = strtoull(value.c_str(), nullptr, 10);
+        else if(option == "--threads") settings.threads = atoi(value.c_str());
+        else if(option == "--repeat") settings.repeat = max(atoi(value.c_str()), 1);
+        else if(option == "--time-tolerance") settings.timeTolerance = atof(value.c_str());
+        else if(option == "--memory-tolerance") settings.memoryTolerance = atof(value.c_str());
+        else if(option == "--min-psnr") settings.minPsnr = atof(value.c_str());
+        else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i - 1]);
+            return 2;
+        }
+    }
+
+    // Baseline: precisa ter sido gravada com a mesma resolução, amostras e semente
+    map<string, SceneResult> baseline;
+    if(!baselineFile.empty()) {
+        Settings saved;
+        string precision;
+        if(!readJson(baselineFile, saved, precision, baseline)) {
+            fprintf(stderr, "Erro: baseline %s não encontrada; grave uma com --save\n", baselineFile.c_str());
+            return 2;
+        } else if(saved.width != settings.width || saved.height != settings.height ||
+                  saved.samplesPerPixel != settings.samplesPerPixel || saved.seed != settings.seed) {
+            fprintf(stderr, "Erro: a baseline %s foi gravada com %dx%d, %d amostras, semente %llu\n", baselineFile.c_str(),
+                    saved.width, saved.height, saved.samplesPerPixel, (unsigned long long)saved.seed);
+            return 2;
+        } else if(precision != precisionName) {
+            printf("aviso: baseline gravada na precisão %s\n", precision.c_str());
+        }
+    }
+
+    vector<string> inputs;
+    for(const auto& entry : filesystem::directory_iterator("inputs")) {
+        if(entry.path().extension() == ".txt") inputs.push_back(entry.path().string());
+    }
+    sort(inputs.begin(), inputs.end());
+    filesystem::create_directories(outDir);
+    if(updateReferences) filesystem::create_directories(referenceDir);
+
+    printf("precisao: %s, %dx%d, %d amostras, semente %llu, melhor de %d\n", precisionName, settings.width,
+           settings.height, settings.samplesPerPixel, (unsigned long long)settings.seed, settings.repeat);
+    printf("%-30s %9s %13s %10s %9s %9s  %s\n", "cena", "s", "raios/s", "pico KiB", "RMSE", "PSNR", "situacao");
+
+    vector<SceneResult> results;
+    int regressions = 0, unchecked = 0;
+    for(const string& input : inputs) {
+        SceneResult r;
+        r.name = filesystem::path(input).stem().string();
+        string output = outDir + "/" + r.name + ".pfm";
+        string reference = referenceDir + "/" + r.name + ".pfm";
+        string status;
+
+        if(!renderScene(input, output, settings, r)) {
+            status = "FALHOU";
+            regressions++;
+        } else {
+            if(updateReferences) {
+                filesystem::copy_file(output, reference, filesystem::copy_options::overwrite_existing);
+            }
+            r.rmse = rmse(output, reference);
+            // Sem referência o RMSE é NAN, e o PSNR também: nada foi comparado
+            if(!std::isnan(r.rmse)) r.psnr = r.rmse > 0 ? 20 * log10(1.0 / r.rmse) : INFINITY;
+            // Sem --baseline faltar algo para comparar só é informado; na verificação contra a baseline a
+            // cena não foi verificada, e isso é um erro
+            bool checking = !baselineFile.empty();
+            if(std::isnan(r.rmse)) {
+                status = checking ? "SEM REFERENCIA" : "sem referencia";
+                if(checking) unchecked++;
+            } else if(r.psnr < settings.minPsnr) {
+                status = "IMAGEM";
+            }
+
+            auto it = baseline.find(r.name);
+            if(it != baseline.end()) {
+                const SceneResult& b = it->second;
+                char change[64];
+                snprintf(change, sizeof(change), "%+.0f%% tempo", 100 * (r.seconds / b.seconds - 1));
+                if(r.seconds > b.seconds * (1 + settings.timeTolerance)) status += string(status.empty() ? "" : ", ") + "LENTO " + change;
+                if(r.peakRssKb > b.peakRssKb * (1 + settings.memoryTolerance)) status += string(status.empty() ? "" : ", ") + "MEMORIA";
+                if(status.empty()) status = string("ok (") + change + ")";
+            } else if(checking) {
+                status += string(status.empty() ? "" : ", ") + "SEM BASELINE";
+                unchecked++;
+            }
+            if(status.empty()) status = "ok";
+            if(status.find("IMAGEM") != string::npos || status.find("LENTO") != string::npos ||
+               status.find("MEMORIA") != string::npos) {
+                regressions++;
+            }
+        }
+
+        printf("%-30s %9.3f %13.0f %10.0f %9.2g %9.2f  %s\n", r.name.c_str(), r.seconds, r.rays / r.seconds,
+               r.peakRssKb, r.rmse, r.psnr, status.c_str());
+        fflush(stdout);
+        results.push_back(r);
+    }
+
+    if(!saveFile.empty()) {
+        if(!writeJson(saveFile, settings, results)) return 2;
+        printf("resultados gravados em %s\n", saveFile.c_str());
+    }
+    if(regressions > 0) printf("%d regressoes\n", regressions);
+    if(unchecked > 0) {
+        fprintf(stderr, "Erro: faltam %d imagens de referência ou entradas na baseline %s; grave-as com --save e --update-references\n",
+                unchecked, baselineFile.c_str());
+        return 2;
+    }
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+// Microbenchmark de GenericMaterial::scatter: mede o tempo por raio (interseção + espalhamento)
+// e conta as alocações de memória feitas por raio depois do aquecimento.
+//
+// Uso: ./bench_scatter [iterações]
+
+#include "component_list.hpp"
+#include "objects/sphere.hpp"
+#include "materials/generic_material.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <new>
+
+using namespace std;
+
+// Conta todas as alocações do processo substituindo o operator new global
+static atomic<long> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if(!p) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+int main(int argc, char** argv) {
+    long iterations = argc >= 2 ? atol(argv[1]) : 2000000;
+
+    TexturePtr white = make_shared<SolidColor>(color(0.9, 0.9, 0.9));
+
+    // Um material de cada lobo e um que mistura os três
+    struct Case { const char* name; MaterialPtr mat; };
+    Case cases[] = {
+        {"lambertian", make_shared<GenericMaterial>(0.1, 0.7, 0.2, 10, 0.0, 0.0, 1.0, white)},
+        {"metal", make_shared<GenericMaterial>(0.1, 0.2, 0.5, 100, 1.0, 0.0, 1.0, white)},
+        {"dielectric", make_shared<GenericMaterial>(0.1, 0.1, 0.3, 1000, 0.0, 1.0, 1.5, white)},
+        {"mixed", make_shared<GenericMaterial>(0.1, 0.3, 0.3, 100, 0.3, 0.3, 1.5, white)},
+    };
+
+    printf("%-12s %12s %16s\n", "material", "ns/raio", "alocacoes/raio");
+    for(const Case& c : cases) {
+        ComponentList world;
+        world.add(make_shared<Sphere>(p3(0, 0, 0), 1.0, c.mat.get()));
+        world.build();
+
+        Random::seed(42);
+        HitRecord rec;
+        Ray scattered;
+        color attenuation;
+        bool isLight = false;
+        double sink = 0;
+
+        auto traceOne = [&]() {
+            Ray r(p3(0, 0, -5), vec3::random(-0.1, 0.1) + vec3(0, 0, 1));
+            if(world.hit(r, 0.001, infinity, rec, false)) {
+                rec.matPtr->scatter(r, rec, attenuation, scattered, isLight);
+                sink += attenuation.x() + scattered.dir.x();
+            }
+        };
+
+        // Aquecimento, depois mede as alocações em regime permanente
+        for(int i = 0; i < 1000; i++) traceOne();
+        long before = allocations;
+        auto start = chrono::steady_clock::now();
+        for(long i = 0; i < iterations; i++) traceOne();
+        auto end = chrono::steady_clock::now();
+        long allocs = allocations - before;
+
+        double ns = chrono::duration<double, nano>(end - start).count() / iterations;
+        printf("%-12s %12.1f %16.3f\n", c.name, ns, double(allocs) / iterations);
+        if(sink == 12345) printf(" ");
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Benchmark dos layouts de texels (ver TextureLayout em texture_cache.hpp). Para cada layout:
+//  1. consultas isoladas a cada imagem de textures/, em dois padrões de acesso: o de uma esfera
+//     texturizada vista de frente, percorrida linha a linha da tela como na renderização
+//     (Sphere::getSphereUV), e coordenadas aleatórias; com os filtros nearest e trilinear no nível
+//     de resolução máxima, que é o que mais sofre com falhas de cache;
+//  2. renderização das cenas de inputs/ que usam texturas de imagem, em amostras por segundo.
+// As imagens são decodificadas de novo para cada layout (o layout é aplicado na carga).
+//
+// Uso: ./bench_texture [largura altura amostras]
+
+#include "renderer.hpp"
+#include "input_processor.hpp"
+#include "texture_cache.hpp"
+#include "objects/sphere.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const int lookups = 1 << 20;
+
+// Coordenadas de textura de uma esfera que ocupa um quadro de side x side pixels, em ordem de varredura
+static vector<vec2> spherePattern(int side) {
+    vector<vec2> uv;
+    for(int y = 0; y < side; y++) {
+        for(int x = 0; x < side; x++) {
+            double px = 2.0 * (x + 0.5) / side - 1, py = 1 - 2.0 * (y + 0.5) / side;
+            double r2 = px * px + py * py;
+            if(r2 >= 1) continue;
+            uv.push_back(Sphere::getSphereUV(p3(px, py, -sqrt(1 - r2))));
+        }
+    }
+    return uv;
+}
+
+static vector<vec2> randomPattern(int count) {
+    vector<vec2> uv(count);
+    Random::seed(1234);
+    for(vec2& c : uv) c = vec2(randomDouble(), randomDouble());
+    return uv;
+}
+
+// ns por consulta, repetindo o padrão até completar lookups consultas
+static double measure(const TextureImage& image, const vector<vec2>& uv, TextureFilter filter, double& sum) {
+    auto start = chrono::steady_clock::now();
+    int done = 0;
+    while(done < lookups) {
+        for(const vec2& c : uv) {
+            sum += image.sample(c.u(), 1 - c.v(), 0, filter).x();
+        }
+        done += uv.size();
+    }
+    auto end = chrono::steady_clock::now();
+    return 1e9 * chrono::duration<double>(end - start).count() / done;
+}
+
+static bool usesImageTexture(const string& path) {
+    ifstream file(path);
+    string line;
+    while(getline(file, line)) {
+        if(line.find("textmap") != string::npos || line.find("texmap") != string::npos) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    int imgWidth = 160, imgHeight = 120, samplesPerPixel = 16;
+    if(argc >= 4) {
+        imgWidth = atoi(argv[1]);
+        imgHeight = atoi(argv[2]);
+        samplesPerPixel = atoi(argv[3]);
+    }
+
+    const TextureLayout layouts[] = {TextureLayout::Linear, TextureLayout::Tiled};
+    const char* layoutNames[] = {"linear", "tiled"};
+
+    vector<string> images, inputs;
+    for(const auto& entry : filesystem::directory_iterator("textures")) images.push_back(entry.path().string());
+    for(const auto& entry : filesystem::directory_iterator("inputs")) {
+        if(entry.path().extension() == ".txt" && usesImageTexture(entry.path().string())) {
+            inputs.push_back(entry.path().string());
+        }
+    }
+    sort(images.begin(), images.end());
+    sort(inputs.begin(), inputs.end());
+
+    vector<vec2> sphere = spherePattern(512), random = randomPattern(lookups);
+    double sum = 0;
+
+    // Silencia as mensagens de carga das texturas e o progresso do renderizador
+    cout.setstate(ios::failbit);
+    cerr.setstate(ios::failbit);
+
+    printf("consultas (ns/consulta, nivel 0)\n");
+    printf("%-26s %-7s %12s %12s %12s %12s\n", "imagem", "layout", "esf nearest", "esf trilin", "rand nearest", "rand trilin");
+    for(const string& path : images) {
+        for(int l = 0; l < 2; l++) {
+            TextureCache::clear();
+            TextureCache::setLayout(layouts[l]);
+            TextureImagePtr image = TextureCache::load(path);
+            if(!image) continue;
+            double ns[4] = {
+                measure(*image, sphere, TextureFilter::Nearest, sum),
+                measure(*image, sphere, TextureFilter::Trilinear, sum),
+                measure(*image, random, TextureFilter::Nearest, sum),
+                measure(*image, random, TextureFilter::Trilinear, sum)
+            };
+            string name = filesystem::path(path).filename().string() + " " + to_string(image->width()) + "x" + to_string(image->height());
+            printf("%-26s %-7s %12.2f %12.2f %12.2f %12.2f\n", name.c_str(), layoutNames[l], ns[0], ns[1], ns[2], ns[3]);
+            fflush(stdout);
+        }
+    }
+
+    printf("\nrenderizacao (%dx%d, %d amostras, amostras/s)\n", imgWidth, imgHeight, samplesPerPixel);
+    printf("%-36s %14s %14s\n", "cena", "linear", "tiled");
+    ThreadPool pool;
+    for(const string& input : inputs) {
+        double rate[2];
+        for(int l = 0; l < 2; l++) {
+            TextureCache::clear();
+            TextureCache::setLayout(layouts[l]);
+            SceneDescription scene;
+            if(!InputProcessor::processFile(input, scene)) return 1;
+            scene.imgWidth = imgWidth;
+            scene.imgHeight = imgHeight;
+            scene.aspectRatio = double(imgWidth) / double(imgHeight);
+            scene.samplesPerPixel = samplesPerPixel;
+
+            auto start = chrono::steady_clock::now();
+            Renderer::render(scene, "/dev/null", pool);
+            auto end = chrono::steady_clock::now();
+            rate[l] = double(imgWidth) * imgHeight * samplesPerPixel / chrono::duration<double>(end - start).count();
+        }
+        string name = filesystem::path(input).stem().string();
+        printf("%-36s %14.0f %14.0f\n", name.c_str(), rate[0], rate[1]);
+        fflush(stdout);
+    }
+
+    cout.clear();
+    cerr.clear();
+    printf("\nsoma de controle: %g\n", sum);
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Microbenchmark das operações de vec3: compara o vec3 atual (4 posições, uma instrução vetorial
+// por operação) com uma cópia da versão escalar anterior (real p[3], um componente por vez).
+// Cada operação percorre arrays de vetores grandes demais para o compilador calcular tudo de
+// antemão, e o resultado é acumulado para não ser descartado.
+//
+// Uso: ./bench_vec3 [repetições]
+
+#include "vec3.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+// vec3 escalar como era antes da troca para real4
+namespace scalar {
+    class vec3 {
+        public:
+            real p[3];
+
+            vec3() : vec3(0, 0, 0) {}
+            vec3(real c0, real c1, real c2) {
+                p[0] = c0;
+                p[1] = c1;
+                p[2] = c2;
+            }
+
+            real x() const { return p[0]; }
+
+            real length() const {
+                return sqrt(lengthSquared());
+            }
+
+            real lengthSquared() const {
+                return p[0]*p[0] + p[1]*p[1] + p[2]*p[2];
+            }
+
+            inline vec3 operator*(const vec3 &v) const {
+                return vec3(p[0] * v.p[0], p[1] * v.p[1], p[2] * v.p[2]);
+            }
+
+            inline vec3 operator/(real t) {
+                return vec3(p[0] / t, p[1] / t, p[2] / t);
+            }
+
+            inline real dot(const vec3 &v) const {
+                const vec3 &u = *this;
+                return u.p[0] * v.p[0] + u.p[1] * v.p[1] + u.p[2] * v.p[2];
+            }
+
+            inline static vec3 cross(const vec3 &u, const vec3 &v) {
+                return vec3(u.p[1] * v.p[2] - u.p[2] * v.p[1],
+                            u.p[2] * v.p[0] - u.p[0] * v.p[2],
+                            u.p[0] * v.p[1] - u.p[1] * v.p[0]);
+            }
+
+            inline vec3 normalize() const {
+                return vec3(p[0], p[1], p[2]) / length();
+            }
+    };
+
+    inline vec3 operator*(real t, const vec3 &v) {
+        return vec3(v.p[0] * t, v.p[1] * t, v.p[2] * t);
+    }
+
+    inline vec3 operator+(const vec3 &u, const vec3 &v) {
+        return vec3(u.p[0] + v.p[0], u.p[1] + v.p[1], u.p[2] + v.p[2]);
+    }
+
+    inline vec3 operator-(const vec3 &u, const vec3 &v) {
+        return vec3(u.p[0] - v.p[0], u.p[1] - v.p[1], u.p[2] - v.p[2]);
+    }
+}
+
+static const int count = 4096;
+
+// Mede ns por operação de op(a[i], b[i]) sobre os arrays, repetido rounds vezes
+template<class V, class Op>
+static double measure(const vector<V>& a, const vector<V>& b, vector<V>& out, int rounds, Op op) {
+    auto start = chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++) {
+        for(int i = 0; i < count; i++) {
+            out[i] = op(a[i], b[i]);
+        }
+        // impede que o compilador reaproveite o resultado entre as repetições
+        asm volatile("" : : "r"(out.data()) : "memory");
+    }
+    auto end = chrono::steady_clock::now();
+    return 1e9 * chrono::duration<double>(end - start).count() / (double(rounds) * count);
+}
+
+// Mesmo que measure, para operações que devolvem um escalar (acumulado numa soma)
+template<class V, class Op>
+static double measureScalar(const vector<V>& a, const vector<V>& b, real& sum, int rounds, Op op) {
+    auto start = chrono::steady_clock::now();
+    for(int r = 0; r < rounds; r++) {
+        real acc = 0;
+        for(int i = 0; i < count; i++) {
+            acc += op(a[i], b[i]);
+        }
+        sum += acc;
+    }
+    auto end = chrono::steady_clock::now();
+    return 1e9 * chrono::duration<double>(end - start).count() / (double(rounds) * count);
+}
+
+template<class V>
+static void run(const char* name, int rounds, double* results) {
+    vector<V> a(count), b(count), out(count);
+    for(int i = 0; i < count; i++) {
+        a[i] = V(rand() / (real)RAND_MAX, rand() / (real)RAND_MAX, rand() / (real)RAND_MAX + 0.5);
+        b[i] = V(rand() / (real)RAND_MAX, rand() / (real)RAND_MAX + 0.5, rand() / (real)RAND_MAX);
+    }
+
+    results[0] = measure(a, b, out, rounds, [](const V& u, const V& v) { return u + v; });
+    results[1] = measure(a, b, out, rounds, [](const V& u, const V& v) { return u * v; });
+    results[2] = measure(a, b, out, rounds, [](const V& u, const V& v) { return (real)2.5 * u - v; });
+    real sum = 0;
+    results[3] = measureScalar(a, b, sum, rounds, [](const V& u, const V& v) { return u.dot(v); });
+    results[4] = measure(a, b, out, rounds, [](const V& u, const V& v) { return V::cross(u, v); });
+    results[5] = measure(a, b, out, rounds, [](const V& u, const V&) { return u.normalize(); });
+
+    for(const V& v : out) sum += v.x();
+    printf("%s: sizeof = %zu, soma de controle = %g\n", name, sizeof(V), (double)sum);
+}
+
+int main(int argc, char** argv) {
+    int rounds = argc >= 2 ? atoi(argv[1]) : 20000;
+    const char* names[] = {"u + v", "u * v", "t * u - v", "dot", "cross", "normalize"};
+    double scalarNs[6], simdNs[6];
+
+    srand(1234);
+    run<scalar::vec3>("escalar", rounds, scalarNs);
+    srand(1234);
+    run<vec3>("real4", rounds, simdNs);
+
+    printf("\n%-12s %14s %14s %10s\n", "operacao", "escalar ns/op", "real4 ns/op", "aceleracao");
+    for(int i = 0; i < 6; i++) {
+        printf("%-12s %14.3f %14.3f %9.2fx\n", names[i], scalarNs[i], simdNs[i], scalarNs[i] / simdNs[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include "hittable.hpp"
+#include "objects/sphere_set.hpp"
+#include "ray_packet.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Nó da BVH em forma achatada. Nós internos guardam em leftFirst o índice do filho esquerdo
+// (o direito é sempre leftFirst + 1); folhas guardam em leftFirst o primeiro primitivo e em
+// count quantos primitivos consecutivos pertencem a ela. Dentro de uma folha as esferas vêm
+// primeiro: as sphereCount iniciais são testadas juntas pelo kernel SIMD de SphereSet.
+struct BVHNode {
+    AABB box;
+    int leftFirst;
+    int count;
+    int sphereCount = 0;
+
+    bool isLeaf() const { return count > 0; }
+};
+
+// Topologia de um nó, como guardada no arquivo de cena binário (ver scene_file.hpp): as caixas não são
+// gravadas e sim recalculadas a partir dos primitivos na carga, na precisão em que o programa foi compilado
+struct BVHBakedNode {
+    int32_t leftFirst;
+    int32_t count;
+};
+
+// Hierarquia de volumes envolventes construída com a heurística de área de superfície (SAH)
+class BVH {
+    public:
+        BVH() {}
+
+        // Constrói a hierarquia sobre os objetos. Todos precisam ter caixa envolvente.
+        void build(const vector<shared_ptr<Hittable>>& objects);
+
+        void clear() {
+            nodes.clear();
+            primitives.clear();
+            spheres.clear();
+        }
+
+        // Topologia pronta para gravar: os nós e, para cada posição de primitives, o índice do objeto
+        // correspondente em objects (a mesma lista passada a build)
+        void bake(const vector<shared_ptr<Hittable>>& objects, vector<BVHBakedNode>& bakedNodes,
+                  vector<uint32_t>& order) const;
+
+        // Reconstrói a hierarquia a partir de uma topologia gravada por bake, sem a construção SAH.
+        // Só as caixas dos nós são calculadas, de baixo para cima, a partir de boxes (a caixa de cada
+        // objeto). Retorna falso (e deixa a BVH vazia) se a topologia não for válida para estes objetos.
+        bool adopt(const vector<shared_ptr<Hittable>>& objects, const vector<AABB>& boxes,
+                   const BVHBakedNode* bakedNodes, size_t nodeCount, const uint32_t* order, size_t orderCount);
+
+        bool empty() const { return nodes.empty(); }
+        int nodeCount() const { return nodes.size(); }
+
+        // Mesma semântica de ComponentList::hit: acertos em materiais "fantasma" só são aceitos
+        // quando reflected é verdadeiro, e não encurtam a busca quando são descartados.
+        bool hit(const Ray& r, real tMin, real tMax, HitRecord& rec, bool reflected) const;
+
+        // Consulta de oclusão para raios de sombra: retorna no primeiro objeto encontrado em
+        // [tMin, tMax], sem procurar o mais próximo nem preencher HitRecord
+        bool occluded(const Ray& r, real tMin, real tMax) const;
+
+        // Versão de hit para um pacote de raios: cada nó é testado contra todos os raios do pacote de
+        // uma vez e só é descartado quando nenhum deles o atravessa. closest[i] é o tMax do raio i e
+        // diminui a cada acerto, que vai para recs[i]. Retorna a máscara dos raios que acertaram algo.
+        int hitPacket(const RayPacket& packet, real tMin, real* closest, HitRecord* recs, bool reflected) const;
+
+    private:
+        static const int maxLeafSize = 4;
+        static const int sahBins = 12;
+        static const int maxTreeDepth = 62;
+
+        vector<BVHNode> nodes;
+        vector<const Hittable*> primitives;
+        SphereSet spheres; // paralelo a primitives; posições que não são esferas ficam vazias
+
+        void finishLeaves();
+        void buildNode(int nodeIndex, int depth, vector<int>& indices, int first, int count,
+                       const vector<AABB>& boxes, const vector<p3>& centroids);
+};
+
+#endif // !BVH_HPP
@@ -18,7 +18,7 @@ class Camera {
         Camera() {}
         
         // vFov stands for vertical field of view, in degrees
-        Camera(p3 lookFrom, p3 lookAt, vec3 vUp,
+        Camera(const p3& lookFrom, const p3& lookAt, const vec3& vUp,
                  double vFov, double aspectRatio,
                  double aperture, double focusDist
         ) : aspectRatio(aspectRatio) {
@@ -0,0 +1,44 @@
+#ifndef CAMERA_PATH_HPP
+#define CAMERA_PATH_HPP
+
+#include "scene_file.hpp"
+#include <string>
+#include <vector>
+
+// Trajetória da câmera para a animação: quadros-chave com os parâmetros da câmera, interpolados
+// para cada quadro intermediário.
+//
+// O arquivo tem um quadro-chave por linha, na mesma ordem da câmera no arquivo de cena:
+//     quadro  lookFrom(x y z)  lookAt(x y z)  vUp(x y z)  vFov  [abertura distância_focal]
+// Linhas vazias e começadas por # são ignoradas. Sem abertura e distância focal, valem as da cena.
+// Os quadros precisam estar em ordem crescente.
+class CameraPath {
+    public:
+        // Lê os quadros-chave; base fornece a abertura e a distância focal omitidas. Erros vão para cerr.
+        bool load(const std::string& path, const CameraRecord& base);
+
+        int firstFrame() const { return keys.front().frame; }
+        int lastFrame() const { return keys.back().frame; }
+
+        // Câmera no quadro frame. As posições (lookFrom e lookAt) seguem uma spline de Hermite com as
+        // tangentes de Catmull-Rom, que passa por todos os quadros-chave sem trancos na velocidade;
+        // vUp, vFov, abertura e distância focal são interpolados linearmente.
+        CameraRecord at(double frame) const;
+
+    private:
+        struct Key {
+            int frame;
+            CameraRecord camera;
+        };
+        std::vector<Key> keys;
+
+        // Posição interpolada por spline: 0 = lookFrom, 1 = lookAt
+        static const double* position(const CameraRecord& camera, int which) {
+            return which == 0 ? camera.lookFrom : camera.lookAt;
+        }
+
+        // Tangente (variação por quadro) da posição which no quadro-chave i
+        void tangent(size_t i, int which, double out[3]) const;
+};
+
+#endif // !CAMERA_PATH_HPP
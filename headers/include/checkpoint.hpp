@@ -0,0 +1,30 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "scene.hpp"
+#include "framebuffer.hpp"
+#include <string>
+
+// Ponto de controle da renderização progressiva: o framebuffer acumulado (somas das amostras em float,
+// contagem de amostras e estimativa de variância de cada pixel) e quantas amostras por pixel as
+// passadas concluídas já pediram. O gerador aleatório é ressemeado a cada amostra a partir de
+// (semente, pixel, índice da amostra), então a semente e a contagem de amostras de cada pixel já
+// determinam o estado do gerador ao retomar: a continuação traça exatamente as amostras seguintes.
+//
+// O arquivo começa com um cabeçalho de tamanho fixo (identificador, versão, dimensões, hash da cena e
+// os parâmetros que mudam as amostras) seguido dos planos do framebuffer, na ordem de bytes da máquina.
+class Checkpoint {
+    public:
+        // Grava num arquivo temporário e o renomeia por cima de path, para que uma interrupção
+        // durante a gravação não destrua o ponto de controle anterior
+        static bool save(const std::string& path, const SceneDescription& scene, const Framebuffer& fb,
+                         int samplesDone);
+
+        // Carrega o ponto de controle em fb. Falha se o arquivo não for compatível com a cena
+        // (outra cena, dimensões, semente, profundidades ou limites da amostragem adaptativa
+        // diferentes). O total de amostras por pixel pode mudar: a renderização continua até ele.
+        static bool load(const std::string& path, const SceneDescription& scene, Framebuffer& fb,
+                         int& samplesDone);
+};
+
+#endif // !CHECKPOINT_HPP
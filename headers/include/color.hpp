@@ -7,11 +7,16 @@
 
 using namespace std;
 
+// Converte um canal em [0,1] para um inteiro em [0,maxValue]
+inline int quantize(double c, int maxValue) {
+    return static_cast<int>((maxValue + 0.999) * clamp(c, 0.0, 1.0));
+}
+
 // Escreve um pixel colorido no stream de saída
 inline void output(ostream &outStream, const vec3& color) {
-    outStream << static_cast<int>(255.999 * clamp(color.x(), 0.0, 1.0)) << " "
-       << static_cast<int>(255.999 * clamp(color.y(), 0.0, 1.0)) << " "
-       << static_cast<int>(255.999 * clamp(color.z(), 0.0, 1.0)) << "\n";
+    outStream << quantize(color.x(), 255) << " "
+       << quantize(color.y(), 255) << " "
+       << quantize(color.z(), 255) << "\n";
 }
 
 // Escreve a cor de um pixel com anti-aliasing (média de múltiplas amostras)
@@ -1,7 +1,9 @@
 #ifndef COMMON_HPP
 #define COMMON_HPP
 
+#include "real.hpp"
 #include "vec2.hpp"
+#include "random.hpp"
 #include <cstdlib>
 #include <limits>
 #include <vector>
@@ -12,7 +14,7 @@
 
 using namespace std;
 
-const double infinity = numeric_limits<double>::infinity();
+const real infinity = numeric_limits<real>::infinity();
 const double pi = 3.1415926535897932385;
 
 // Utility Functions
@@ -20,8 +22,8 @@ inline double degreesToRadians(double degrees) {
     return degrees * pi / 180.0;
 }
 
-inline double randomDouble() { // [0,1)
-    return rand() / (RAND_MAX + 1.0);
+inline double randomDouble() { // [0,1), gerador da thread atual (ver random.hpp)
+    return Random::nextDouble();
 }
 
 inline double randomDouble(double min, double max) { // min,max).
@@ -2,6 +2,7 @@
 #define COMPONENT_LIST_HPP
 
 #include "hittable.hpp"
+#include "bvh.hpp"
 
 #include <memory>
 #include <vector>
@@ -18,24 +19,105 @@ class ComponentList {
             add(object);
         }
 
-        void clear() { 
+        void clear() {
             objects.clear();
+            invalidate();
         }
 
         void add(shared_ptr<Hittable> object) {
             objects.push_back(object);
+            invalidate();
         }
 
-        bool hit(const Ray& r, double tMin, double tmaX, HitRecord& rec, bool reflected) const;
+        // Constrói a BVH sobre os objetos limitados. Objetos sem caixa envolvente (poliedros abertos)
+        // continuam sendo testados um a um. Deve ser chamado depois que a cena estiver completa.
+        void build();
+
+        // Como build(), mas reaproveitando a topologia da BVH gravada num arquivo de cena (ver BVH::adopt).
+        // Retorna falso se ela não servir para estes objetos; nesse caso a BVH é construída do zero.
+        bool build(const BVHBakedNode* nodes, size_t nodeCount, const uint32_t* order, size_t orderCount);
+
+        // Topologia da BVH construída, para gravar num arquivo de cena (ver BVH::bake)
+        void bake(vector<BVHBakedNode>& nodes, vector<uint32_t>& order) const;
+
+        bool isBuilt() const { return built; }
+
+        bool hit(const Ray& r, real tMin, real tmaX, HitRecord& rec, bool reflected) const;
+
+        // Verdadeiro se algum objeto (inclusive de material fantasma) corta o raio em [tMin, tMax].
+        // Usado nos raios de sombra: para no primeiro bloqueador encontrado.
+        bool occluded(const Ray& r, real tMin, real tMax) const;
+
+        // hit para um pacote de raios (ver BVH::hitPacket): recs[i] recebe o acerto do raio i e o
+        // bit i do retorno indica se ele acertou algo
+        int hitPacket(const RayPacket& packet, real tMin, real tMax, HitRecord* recs, bool reflected) const;
+
+    private:
+        bool built = false;
+        BVH bvh;
+        vector<shared_ptr<Hittable>> unbounded;
+
+        // Separa os objetos com caixa envolvente (para a BVH) dos que ficam em unbounded. Se boxes não
+        // for nulo, recebe as caixas dos objetos de bounded.
+        void splitBounded(vector<shared_ptr<Hittable>>& bounded, vector<AABB>* boxes = nullptr);
+
+        void invalidate() {
+            built = false;
+            bvh.clear();
+            unbounded.clear();
+        }
 };
 
+inline void ComponentList::build() {
+    vector<shared_ptr<Hittable>> bounded;
+    splitBounded(bounded);
+    bvh.build(bounded);
+    built = true;
+}
+
+inline bool ComponentList::build(const BVHBakedNode* nodes, size_t nodeCount, const uint32_t* order, size_t orderCount) {
+    vector<shared_ptr<Hittable>> bounded;
+    vector<AABB> boxes;
+    splitBounded(bounded, &boxes);
+    bool adopted = bvh.adopt(bounded, boxes, nodes, nodeCount, order, orderCount);
+    if(!adopted) bvh.build(bounded);
+    built = true;
+    return adopted;
+}
+
+inline void ComponentList::bake(vector<BVHBakedNode>& nodes, vector<uint32_t>& order) const {
+    vector<shared_ptr<Hittable>> bounded;
+    AABB box;
+    for(const auto& ob : objects) {
+        if(ob->boundingBox(box)) bounded.push_back(ob);
+    }
+    bvh.bake(bounded, nodes, order);
+}
+
+inline void ComponentList::splitBounded(vector<shared_ptr<Hittable>>& bounded, vector<AABB>* boxes) {
+    unbounded.clear();
+
+    AABB box;
+    for(const auto& ob : objects) {
+        if(ob->boundingBox(box)) {
+            bounded.push_back(ob);
+            if(boxes) boxes->push_back(box);
+        } else {
+            unbounded.push_back(ob);
+        }
+    }
+}
+
 // Verifica se o raio atinge algum objeto na lista
-inline bool ComponentList::hit(const Ray& r, double tMin, double tMax, HitRecord& rec, bool reflected) const {
+inline bool ComponentList::hit(const Ray& r, real tMin, real tMax, HitRecord& rec, bool reflected) const {
     HitRecord tempRecord;
     bool hitAnything = false;
-    double closest = tMax;
+    real closest = tMax;
 
-    for(const auto& ob : objects) {
+    // Sem BVH (lista ainda não construída) todos os objetos são testados
+    const vector<shared_ptr<Hittable>>& linear = built ? unbounded : objects;
+
+    for(const auto& ob : linear) {
         if(ob->hit(r, tMin, closest, tempRecord)) {
             if(reflected || !tempRecord.matPtr->ghostMaterial) {
                 hitAnything = true;
@@ -45,7 +127,50 @@ inline bool ComponentList::hit(const Ray& r, double tMin, double tMax, HitRecord
         }
     }
 
+    if(built && bvh.hit(r, tMin, closest, rec, reflected)) {
+        hitAnything = true;
+    }
+
     return hitAnything;
 }
 
-#endif // !COMPONENT_LIST_HPP
\ No newline at end of file
+inline bool ComponentList::occluded(const Ray& r, real tMin, real tMax) const {
+    const vector<shared_ptr<Hittable>>& linear = built ? unbounded : objects;
+
+    for(const auto& ob : linear) {
+        if(ob->occluded(r, tMin, tMax)) return true;
+    }
+
+    return built && bvh.occluded(r, tMin, tMax);
+}
+
+inline int ComponentList::hitPacket(const RayPacket& packet, real tMin, real tMax, HitRecord* recs, bool reflected) const {
+    int hitMask = 0;
+
+    if(!built) {
+        for(int lane = 0; lane < packet.size; lane++) {
+            if(hit(packet.rays[lane], tMin, tMax, recs[lane], reflected)) hitMask |= 1 << lane;
+        }
+        return hitMask;
+    }
+
+    // Objetos sem caixa envolvente primeiro, raio a raio, como em hit
+    real closest[RayPacket::maxSize];
+    HitRecord tempRecord;
+    for(int lane = 0; lane < packet.size; lane++) {
+        closest[lane] = tMax;
+        for(const auto& ob : unbounded) {
+            if(ob->hit(packet.rays[lane], tMin, closest[lane], tempRecord)) {
+                if(reflected || !tempRecord.matPtr->ghostMaterial) {
+                    hitMask |= 1 << lane;
+                    closest[lane] = tempRecord.t;
+                    recs[lane] = tempRecord;
+                }
+            }
+        }
+    }
+
+    return hitMask | bvh.hitPacket(packet, tMin, closest, recs, reflected);
+}
+
+#endif // !COMPONENT_LIST_HPP
@@ -0,0 +1,40 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include "scene.hpp"
+#include <string>
+#include <vector>
+
+// Renderização de uma imagem por vários processos, na mesma máquina ou em várias, coordenados por um
+// diretório compartilhado (um diretório local ou montado por rede, como NFS).
+//
+// A imagem é dividida em unidades de algumas faixas inteiras de blocos do Renderer. O coordenador grava
+// em dir a descrição do trabalho (dimensões, hash da cena, parâmetros que mudam as amostras e um
+// identificador) e cada worker, carregado com a mesma cena e as mesmas opções, reivindica unidades
+// criando o arquivo <id>.<unidade>.claim de forma exclusiva (O_EXCL), as renderiza e grava o resultado,
+// as somas, contagens e variância de cada pixel, em <id>.<unidade>.part, por renomeação: o coordenador só
+// enxerga partes completas. O coordenador também renderiza unidades enquanto houver alguma livre, copia as partes para o
+// framebuffer final e grava a imagem.
+//
+// O gerador aleatório é ressemeado a cada amostra a partir de (semente, pixel, índice da amostra), então
+// cada pixel sai igual qualquer que seja o processo que o renderizou: a imagem é idêntica byte a byte à
+// de um único processo, com qualquer número de workers.
+class DistributedRender {
+    public:
+        // Coordenador: publica o trabalho em dir, inicia workerCount workers locais com workerCommand
+        // (argv completo, sem o diretório), renderiza as unidades livres, espera as demais e grava
+        // outputFile. unitRows é arredondado para um múltiplo de Renderer::tileSize. Unidades
+        // reivindicadas por um worker desta máquina que terminou sem entregá-las são renderizadas pelo
+        // próprio coordenador; as de workers de outras máquinas são esperadas.
+        static bool coordinate(const SceneDescription& scene, const std::string& outputFile, const std::string& dir,
+                               const std::vector<std::string>& workerCommand, int workerCount, int unitRows);
+
+        // Worker: espera o trabalho aparecer em dir (até jobWaitSeconds), confere que a cena é a mesma
+        // (SceneDescription::sceneHash) e tem os mesmos parâmetros e renderiza unidades até não restar
+        // nenhuma livre
+        static bool work(const SceneDescription& scene, const std::string& dir);
+
+        static const int jobWaitSeconds = 300;
+};
+
+#endif // !DISTRIBUTED_HPP
@@ -0,0 +1,74 @@
+#ifndef FRAME_ENCODER_HPP
+#define FRAME_ENCODER_HPP
+
+#include "framebuffer.hpp"
+#include "image_writer.hpp"
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Gravação dos quadros de uma animação numa thread própria, enquanto o próximo quadro é renderizado.
+//
+// Dois destinos: uma imagem por quadro (prefixo_0000.ppm, prefixo_0001.ppm, ... no formato de
+// ImageWriter escolhido) ou um único arquivo Y4M (YUV4MPEG2, 4:4:4, faixa de vídeo do BT.601), que
+// ffmpeg e os players de vídeo leem direto. Os framebuffers circulam entre o renderizador e o
+// codificador: acquire() devolve um já gravado (ou um novo, até bufferCount) e submit() o entrega para
+// gravação, então a memória usada não cresce com o número de quadros.
+class FrameEncoder {
+    public:
+        static const int bufferCount = 3; // um em renderização, um em gravação e um na fila
+
+        FrameEncoder() {}
+        ~FrameEncoder() { finish(); }
+
+        FrameEncoder(const FrameEncoder&) = delete;
+        FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+        // output terminado em .y4m grava um vídeo; qualquer outro nome é o prefixo das imagens
+        bool open(const std::string& output, ImageFormat format, int width, int height, int fps);
+
+        // Framebuffer limpo com as dimensões dos quadros; espera se todos estão em uso
+        std::unique_ptr<Framebuffer> acquire();
+
+        // Entrega o quadro renderizado para gravação
+        void submit(int frame, std::unique_ptr<Framebuffer> fb);
+
+        // Espera a gravação dos quadros pendentes e fecha a saída. Falso se alguma gravação falhou.
+        bool finish();
+
+        // Nome do arquivo do quadro no modo de imagens por quadro
+        std::string framePath(int frame) const;
+
+    private:
+        struct Pending {
+            int frame;
+            std::unique_ptr<Framebuffer> fb;
+        };
+
+        std::string output;
+        ImageFormat format = ImageFormat::PPM_BINARY;
+        bool y4m = false;
+        int width = 0, height = 0;
+        std::ofstream video;
+        std::vector<char> planes;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<Pending> queue;
+        std::vector<std::unique_ptr<Framebuffer>> spare;
+        int allocated = 0;
+        bool closing = false;
+        bool failed = false;
+
+        void run();
+        bool write(const Pending& p);
+        bool writeY4M(const Framebuffer& fb);
+};
+
+#endif // !FRAME_ENCODER_HPP
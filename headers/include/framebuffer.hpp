@@ -0,0 +1,127 @@
+#ifndef FRAMEBUFFER_HPP
+#define FRAMEBUFFER_HPP
+
+#include "vec3.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+// Buffer de imagem contíguo usado pelo renderizador.
+//
+// Guarda, para cada pixel, a soma das amostras em float32 (RGB + um canal de preenchimento, 16 bytes),
+// o número de amostras e a média/M2 da luminância (algoritmo de Welford) para estimar a variância.
+// Cada plano é alinhado a 64 bytes e o passo das linhas é arredondado para um múltiplo da largura
+// dos blocos, então blocos de tileSize pixels começam sempre numa linha de cache própria e
+// threads que renderizam blocos vizinhos não disputam as mesmas linhas de cache (false sharing).
+// As linhas são indexadas como na renderização: a linha 0 é a de baixo.
+class Framebuffer {
+    public:
+        static const int alignment = 64;
+
+        // tileSize precisa ser múltiplo de 16 para que os blocos caiam em linhas de cache distintas
+        Framebuffer(int width, int height, int tileSize = 16) : w(width), h(height) {
+            stridePixels = ((width + tileSize - 1) / tileSize) * tileSize;
+            size_t pixels = size_t(stridePixels) * height;
+            accum = (float*)allocate(pixels * 4 * sizeof(float));
+            samples = (uint32_t*)allocate(pixels * sizeof(uint32_t));
+            lumMean = (float*)allocate(pixels * sizeof(float));
+            lumM2 = (float*)allocate(pixels * sizeof(float));
+            clear();
+        }
+
+        ~Framebuffer() {
+            free(accum);
+            free(samples);
+            free(lumMean);
+            free(lumM2);
+        }
+
+        Framebuffer(const Framebuffer&) = delete;
+        Framebuffer& operator=(const Framebuffer&) = delete;
+
+        int width() const { return w; }
+        int height() const { return h; }
+        int stride() const { return stridePixels; }
+        size_t pixelCount() const { return size_t(stridePixels) * h; }
+
+        void clear() {
+            size_t pixels = pixelCount();
+            for(size_t i = 0; i < pixels; i++) {
+                accum[4 * i] = accum[4 * i + 1] = accum[4 * i + 2] = accum[4 * i + 3] = 0.0f;
+                samples[i] = 0;
+                lumMean[i] = lumM2[i] = 0.0f;
+            }
+        }
+
+        size_t index(int row, int col) const { return size_t(row) * stridePixels + col; }
+
+        // Acumula uma amostra no pixel e atualiza a estimativa de variância
+        void addSample(int row, int col, const color& c) {
+            size_t i = index(row, col);
+            float* px = accum + 4 * i;
+            px[0] += (float)c.x();
+            px[1] += (float)c.y();
+            px[2] += (float)c.z();
+
+            uint32_t n = ++samples[i];
+            float lum = (float)luminance(c);
+            float delta = lum - lumMean[i];
+            lumMean[i] += delta / n;
+            lumM2[i] += delta * (lum - lumMean[i]);
+        }
+
+        uint32_t sampleCount(int row, int col) const { return samples[index(row, col)]; }
+
+        // Média das amostras do pixel (a cor final, antes da quantização)
+        color resolve(int row, int col) const {
+            size_t i = index(row, col);
+            uint32_t n = samples[i];
+            if(n == 0) return color(0, 0, 0);
+            const float* px = accum + 4 * i;
+            double inv = 1.0 / n;
+            return color(px[0] * inv, px[1] * inv, px[2] * inv);
+        }
+
+        // Variância amostral da luminância do pixel
+        double variance(int row, int col) const {
+            size_t i = index(row, col);
+            return samples[i] > 1 ? lumM2[i] / (samples[i] - 1) : 0.0;
+        }
+
+        // Erro padrão da média da luminância (desvio padrão / raiz do número de amostras), nas
+        // unidades da imagem de saída; usado como estimativa do ruído que resta no pixel
+        double standardError(int row, int col) const {
+            uint32_t n = samples[index(row, col)];
+            return n > 1 ? std::sqrt(variance(row, col) / n) : INFINITY;
+        }
+
+        // Acesso direto aos planos, sem cópia (passo de linha = stride())
+        float* accumData() { return accum; }
+        const float* accumData() const { return accum; }
+        uint32_t* sampleData() { return samples; }
+        const uint32_t* sampleData() const { return samples; }
+        float* meanData() { return lumMean; }
+        const float* meanData() const { return lumMean; }
+        float* m2Data() { return lumM2; }
+        const float* m2Data() const { return lumM2; }
+
+        static double luminance(const color& c) {
+            return 0.2126 * c.x() + 0.7152 * c.y() + 0.0722 * c.z();
+        }
+
+    private:
+        int w, h;
+        int stridePixels;
+        float* accum;
+        uint32_t* samples;
+        float* lumMean;
+        float* lumM2;
+
+        static void* allocate(size_t bytes) {
+            // aligned_alloc exige tamanho múltiplo do alinhamento
+            size_t rounded = ((bytes + alignment - 1) / alignment) * alignment;
+            return aligned_alloc(alignment, rounded > 0 ? rounded : alignment);
+        }
+};
+
+#endif // !FRAMEBUFFER_HPP
@@ -0,0 +1,59 @@
+#ifndef IMAGE_WRITER_HPP
+#define IMAGE_WRITER_HPP
+
+#include "framebuffer.hpp"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Formatos de imagem suportados na saída
+enum class ImageFormat {
+    PPM_ASCII,   // P3, texto (formato original)
+    PPM_BINARY,  // P6, 8 bits por canal
+    PPM_16,      // P6 com maxval 65535, 16 bits por canal (big-endian)
+    PFM          // Portable Float Map, float32 por canal, sem limitação de faixa (HDR)
+};
+
+// Camada de saída de imagens. Os escritores leem diretamente do Framebuffer, sem cópia
+// intermediária, e cada chamada a writeRows converte o lote inteiro de linhas para um único
+// buffer gravado com uma só chamada a write. Isso permite gravar faixas prontas da imagem
+// enquanto o resto ainda está sendo renderizado.
+class ImageWriter {
+    public:
+        static std::unique_ptr<ImageWriter> create(ImageFormat format);
+
+        // Converte "p3", "p6", "ppm16" ou "pfm" no formato correspondente
+        static bool parseFormat(const std::string& name, ImageFormat& format);
+
+        // Extensão usual do formato (".ppm" ou ".pfm")
+        static const char* extension(ImageFormat format);
+
+        virtual ~ImageWriter() {}
+
+        bool open(const std::string& path, int width, int height);
+
+        // Grava as linhas [rowFrom, rowTo] do framebuffer (índices de renderização, 0 = linha de baixo),
+        // na ordem do arquivo. Faixas sucessivas precisam ser entregues na ordem do arquivo.
+        void writeRows(const Framebuffer& fb, int rowFrom, int rowTo);
+
+        bool close();
+
+        // PPM guarda a linha de cima primeiro; PFM guarda a linha de baixo primeiro
+        virtual bool topDown() const { return true; }
+
+    protected:
+        int width = 0;
+        int height = 0;
+
+        virtual std::string header() const = 0;
+
+        // Acrescenta ao fim de out a linha row já convertida para o formato
+        virtual void encodeRow(const Framebuffer& fb, int row, std::vector<char>& out) const = 0;
+
+    private:
+        std::ofstream file;
+        std::vector<char> buffer;
+};
+
+#endif // !IMAGE_WRITER_HPP
@@ -2,23 +2,33 @@
 #define INPUT_PROCESSOR_HPP
 
 #include "scene.hpp"
+#include "scene_file.hpp"
+#include "text_reader.hpp"
 #include <string>
-#include <fstream>
+#include <string_view>
 
 // Classe responsável por processar arquivos de entrada e popular a SceneDescription
 class InputProcessor {
 public:
-    // Processa um arquivo de entrada completo e retorna a descrição da cena
-    static SceneDescription processFile(const std::string& filename);
+    // Processa um arquivo de entrada completo e preenche a descrição da cena. O arquivo é mapeado
+    // em memória e lido sem cópias nem alocações por linha (ver TextReader). Aceita também o
+    // formato binário de SceneFile, reconhecido pelo identificador no início do arquivo. Retorna
+    // falso se o arquivo não puder ser aberto ou tiver um erro (a mensagem vai para cerr); nesse
+    // caso a cena fica incompleta e não deve ser renderizada.
+    static bool processFile(const std::string& filename, SceneDescription& scene);
+    
+    // Lê uma cena no formato texto para registros (ver SceneData), sem criar os objetos. Erros de
+    // formato vão para cerr, a leitura para na linha do erro e o retorno é falso.
+    static bool parseFile(std::string_view contents, const std::string& filename, SceneData& data);
     
 private:
     // Métodos auxiliares para processar cada seção do arquivo
-    static void parseCameraSettings(std::ifstream& file, SceneDescription& scene);
-    static void parseLights(std::ifstream& file, SceneDescription& scene);
-    static void parsePigments(std::ifstream& file, SceneDescription& scene);
-    static void parseMaterials(std::ifstream& file, SceneDescription& scene);
-    static void parseObjects(std::ifstream& file, SceneDescription& scene);
-    static void parseFocusSettings(std::ifstream& file, SceneDescription& scene);
+    static void parseCameraSettings(TextReader& reader, SceneData& data);
+    static void parseLights(TextReader& reader, SceneData& data);
+    static void parsePigments(TextReader& reader, SceneData& data);
+    static void parseMaterials(TextReader& reader, SceneData& data);
+    static void parseObjects(TextReader& reader, SceneData& data);
+    static void parseFocusSettings(TextReader& reader, SceneData& data);
 };
 
 #endif
@@ -1,6 +1,11 @@
 #ifndef DIALECTRIC_MATERIAL_HPP
 #define DIALECTRIC_MATERIAL_HPP
 
+#include "common.hpp"
+#include "material.hpp"
+#include "hittable.hpp"
+#include "texture.hpp"
+
 class DialectricMaterial : public Material {
     public:
         double indexOfrefraction;
@@ -12,7 +17,12 @@ class DialectricMaterial : public Material {
         DialectricMaterial(double indexOfrefraction, TexturePtr col) : indexOfrefraction(indexOfrefraction), col(col) {}
 
         virtual bool scatter(const Ray& rIn, const HitRecord& rec, color& attenuation, Ray& scattered, bool &isLight) const override {
-            attenuation = col == nullptr ? color(1.0, 1.0, 1.0) : col->value(rec.uv, rec.p);
+            return scatterWith(col.get(), indexOfrefraction, fuziness, rIn, rec, attenuation, scattered);
+        }
+
+        // Stateless dielectric lobe, shared with GenericMaterial. A null texture means a clear (white) dielectric.
+        static bool scatterWith(const Texture* col, double indexOfrefraction, double fuziness, const Ray& rIn, const HitRecord& rec, color& attenuation, Ray& scattered) {
+            attenuation = col == nullptr ? color(1.0, 1.0, 1.0) : col->value(rec.uv, rec.p, rec.footprint);
             double refractionRatio = rec.rayComingFromOutside ? (1.0 / indexOfrefraction) : (indexOfrefraction);
 
             vec3 unitDirection = rIn.direction().normalize();
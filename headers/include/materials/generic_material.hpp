@@ -11,7 +11,7 @@ class GenericMaterial : public Material {
         double reflectionCoefficient;
         double refractionCoefficient;
         double indexOfrefraction;
-        double fuzz;
+        double fuzz = 0;
 
         TexturePtr col = nullptr;
 
@@ -50,21 +50,18 @@ class GenericMaterial : public Material {
 
             // small hack to force a the sphere background to not infinetely accumulate the same color when diffusing reflecting
             if(reflectionCoefficient < 0.01 && refractionCoefficient < 0.01  && indexOfrefraction < 0.01) {
-                attenuation = col->value(rec.uv, rec.p);
+                attenuation = col->value(rec.uv, rec.p, rec.footprint);
                 return false;
             }
 
+            // Pick one lobe and call its stateless scatter directly: no temporary material, no allocation
             if(randomCoefficient < reflectionCoefficient) {
-                MaterialPtr matPtr = make_shared<MetalMaterial>(col, fuzz);
-                return matPtr->scatter(rIn, rec, attenuation, scattered, isLight);
+                return MetalMaterial::scatterWith(*col, fuzz < 1.0 ? fuzz : 1.0, rIn, rec, attenuation, scattered);
             }else if(randomCoefficient < reflectionCoefficient + refractionCoefficient) {
-                MaterialPtr matPtr = make_shared<DialectricMaterial>(indexOfrefraction, fuzz);
-                return matPtr->scatter(rIn, rec, attenuation, scattered, isLight);
+                return DialectricMaterial::scatterWith(nullptr, indexOfrefraction, fuzz, rIn, rec, attenuation, scattered);
             }else{
-                MaterialPtr matPtr = make_shared<LambertianMaterial>(col);
-                return matPtr->scatter(rIn, rec, attenuation, scattered, isLight);
+                return LambertianMaterial::scatterWith(*col, rec, attenuation, scattered);
             }
-            return true;
         }
 };
 
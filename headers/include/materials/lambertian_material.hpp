@@ -4,6 +4,7 @@
 #include "common.hpp"
 #include "material.hpp"
 #include "ray.hpp"
+#include "hittable.hpp"
 #include "texture.hpp"
 #include "solid_color.hpp"
 #include "image_texture.hpp"
@@ -17,6 +18,11 @@ class LambertianMaterial : public Material {
         LambertianMaterial(const TexturePtr& col) : col(col) {}
 
         virtual bool scatter(const Ray& rIn, const HitRecord& hr, color& attenuation, Ray& scattered, bool &isLight) const override {
+            return scatterWith(*col, hr, attenuation, scattered);
+        }
+
+        // Stateless diffuse lobe, shared with GenericMaterial
+        static bool scatterWith(const Texture& col, const HitRecord& hr, color& attenuation, Ray& scattered) {
             auto scatterDirection = hr.normal.normalize() + vec3::randomUnitVector();
 
             // If the scatter direction is close to 0, NaN issues would occur.
@@ -24,7 +30,7 @@ class LambertianMaterial : public Material {
                 scatterDirection = hr.normal;
 
             scattered = Ray(hr.p, scatterDirection);
-            attenuation = col->value(hr.uv, hr.p);
+            attenuation = col.value(hr.uv, hr.p, hr.footprint);
             return true;
         }
 };
@@ -1,6 +1,12 @@
 #ifndef METAL_HPP
 #define METAL_HPP
 
+#include "common.hpp"
+#include "material.hpp"
+#include "hittable.hpp"
+#include "texture.hpp"
+#include "solid_color.hpp"
+
 class MetalMaterial : public Material {
     public:
         TexturePtr col;
@@ -9,9 +15,15 @@ class MetalMaterial : public Material {
         MetalMaterial(const TexturePtr& col, double fuziness) : col(col), fuziness(fuziness < 1.0 ? fuziness : 1.0) {} 
 
         virtual bool scatter(const Ray& rIn, const HitRecord& hr, color& attenuation, Ray& scattered, bool &isLight) const override {
+            return scatterWith(*col, fuziness, rIn, hr, attenuation, scattered);
+        }
+
+        // Stateless metal lobe, shared with GenericMaterial so it never has to build a MetalMaterial per bounce.
+        // fuziness must already be clamped to [0,1].
+        static bool scatterWith(const Texture& col, double fuziness, const Ray& rIn, const HitRecord& hr, color& attenuation, Ray& scattered) {
             auto reflected = rIn.direction().normalize().reflect(hr.normal);
             scattered = Ray(hr.p, reflected + fuziness * vec3::randomInUnitSphere());
-            attenuation = col->value(hr.uv, hr.p);
+            attenuation = col.value(hr.uv, hr.p, hr.footprint);
 
             // Avoid rays reflecting in the interior of the object
             // Uncommenting this line will make the code faster but will prevent refracted rays from being reflected inside the object
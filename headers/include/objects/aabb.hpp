@@ -0,0 +1,78 @@
+#ifndef AABB_HPP
+#define AABB_HPP
+
+#include "vec3.hpp"
+#include "ray.hpp"
+
+// Axis-aligned bounding box, used by the BVH to discard whole groups of objects at once.
+// An empty box has minimum = +inf and maximum = -inf, so expanding it by any box gives that box.
+class AABB {
+    public:
+        p3 minimum;
+        p3 maximum;
+
+        AABB() : minimum(infinity, infinity, infinity), maximum(-infinity, -infinity, -infinity) {}
+        AABB(const p3& a, const p3& b) : minimum(a), maximum(b) {}
+
+        p3 min() const { return minimum; }
+        p3 max() const { return maximum; }
+
+        bool empty() const {
+            return minimum.x() > maximum.x() || minimum.y() > maximum.y() || minimum.z() > maximum.z();
+        }
+
+        void expand(const p3& p) {
+            for(int a = 0; a < 3; a++) {
+                minimum[a] = fmin(minimum[a], p[a]);
+                maximum[a] = fmax(maximum[a], p[a]);
+            }
+        }
+
+        void expand(const AABB& box) {
+            for(int a = 0; a < 3; a++) {
+                minimum[a] = fmin(minimum[a], box.minimum[a]);
+                maximum[a] = fmax(maximum[a], box.maximum[a]);
+            }
+        }
+
+        p3 centroid() const {
+            return p3(0.5 * (minimum.x() + maximum.x()),
+                      0.5 * (minimum.y() + maximum.y()),
+                      0.5 * (minimum.z() + maximum.z()));
+        }
+
+        real surfaceArea() const {
+            if(empty()) return 0;
+            real dx = maximum.x() - minimum.x();
+            real dy = maximum.y() - minimum.y();
+            real dz = maximum.z() - minimum.z();
+            return 2.0 * (dx * dy + dy * dz + dz * dx);
+        }
+
+        // Slab test. invDir is 1/r.dir, computed once per ray by the caller since the same ray is
+        // tested against many boxes during a traversal.
+        bool hit(const p3& origin, const v3& invDir, real tMin, real tMax) const {
+            for(int a = 0; a < 3; a++) {
+                real t0 = (minimum[a] - origin[a]) * invDir[a];
+                real t1 = (maximum[a] - origin[a]) * invDir[a];
+                if(invDir[a] < 0.0) std::swap(t0, t1);
+                tMin = t0 > tMin ? t0 : tMin;
+                tMax = t1 < tMax ? t1 : tMax;
+                if(tMax < tMin) return false;
+            }
+            return true;
+        }
+
+        bool hit(const Ray& r, real tMin, real tMax) const {
+            v3 invDir(1.0 / r.dir.x(), 1.0 / r.dir.y(), 1.0 / r.dir.z());
+            return hit(r.orig, invDir, tMin, tMax);
+        }
+
+        static AABB surrounding(const AABB& a, const AABB& b) {
+            AABB box = a;
+            box.expand(b);
+            return box;
+        }
+};
+
+#endif // !AABB_HPP
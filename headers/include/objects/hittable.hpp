@@ -4,19 +4,35 @@
 #include "ray.hpp"
 #include "common.hpp"
 #include "material.hpp"
+#include "aabb.hpp"
+#include "texture.hpp"
 
 struct HitRecord {
     p3 p;
     v3 normal;
-    double t;
+    real t;
     vec2 uv; // U,V surface coordinates of the hit point
     bool rayComingFromOutside;
-    shared_ptr<Material> matPtr;
+    const Material* matPtr; // non-owning; materials are owned by SceneDescription::objectMaterials
+    Footprint footprint; // uvPerUnit is filled by the object, width by the renderer
 };
 
 class Hittable {
     public:
-        virtual bool hit(const Ray& r, double tMin, double tMax, HitRecord &rec) const = 0;
+        virtual bool hit(const Ray& r, real tMin, real tMax, HitRecord &rec) const = 0;
+
+        // Any-hit query for shadow rays: true if the ray hits the object anywhere in [tMin, tMax].
+        // Objects override it to skip filling a HitRecord; the default falls back to hit.
+        virtual bool occluded(const Ray& r, real tMin, real tMax) const {
+            HitRecord rec;
+            return hit(r, tMin, tMax, rec);
+        }
+
+        // Fills outputBox with a box enclosing the object. Returns false for unbounded objects,
+        // which are then kept out of the BVH and tested against every ray.
+        virtual bool boundingBox(AABB& outputBox) const = 0;
+
+        virtual ~Hittable() {}
 };
 
 #endif // !HITTABLE_HPP
\ No newline at end of file
@@ -11,9 +11,11 @@ class Light : public Hittable {
         p3 center;
         shared_ptr<LightMaterial> matPtr;
 
-        Light(p3 center, shared_ptr<LightMaterial> m) : center(center), matPtr(m) {};
+        Light(const p3& center, shared_ptr<LightMaterial> m) : center(center), matPtr(m) {};
 
-        bool hit(const Ray& r, double tMin, double tMax, HitRecord &rec) const override { return false; }
+        bool hit(const Ray& r, real tMin, real tMax, HitRecord &rec) const override { return false; }
+
+        bool boundingBox(AABB& outputBox) const override { return false; }
 };
 
 
@@ -8,21 +8,27 @@
 
 class Plane {
     public:
-        double a, b, c, d;
-        Plane(double a, double b, double c, double d) : a(a), b(b), c(c), d(d) {};
+        real a, b, c, d;
+        Plane(real a, real b, real c, real d) : a(a), b(b), c(c), d(d) {};
 };
 
 
 class Polyhedron : public Hittable {
     public:
         vector<Plane> faces;
-        shared_ptr<Material> matPtr;
+        const Material* matPtr; // non-owning, see SceneDescription::objectMaterials
 
-        Polyhedron(shared_ptr<Material> m) : matPtr(m) {};
+        Polyhedron(const Material* m) : matPtr(m) {};
 
         // check ray colision with polyhedron
         // this function considers the vectorized polyhedron equation and solve it for t, t is the multiplier of the direction on the Ray's formula.
-        bool hit(const Ray& r, double tMin, double tMax, HitRecord &rec) const override;
+        bool hit(const Ray& r, real tMin, real tMax, HitRecord &rec) const override;
+
+        bool occluded(const Ray& r, real tMin, real tMax) const override;
+
+        // the polyhedron is the intersection of the half-spaces ax + by + cz + d <= 0, so its box is spanned by the
+        // vertices where three faces meet. Returns false when the half-spaces leave the solid open in some direction.
+        bool boundingBox(AABB& outputBox) const override;
 
         void addFace(Plane p) {
             faces.push_back(p);
@@ -37,21 +43,25 @@ class Polyhedron : public Hittable {
         }
 
         static vec2 getPolyhedronUV(const p3& p);
+
+    private:
+        // clips the ray against every face. On success t is the hit distance and entering tells whether
+        // the ray hits the entry face nT0 (t = clipped tMin) or, starting inside, the exit face nT1
+        bool clip(const Ray& r, real tMin, real tMax, real& t, bool& entering, vec4& nT0, vec4& nT1) const;
 };
 
 
-bool Polyhedron::hit(const Ray &r, double tMin, double tMax, HitRecord &rec) const {
+inline bool Polyhedron::clip(const Ray &r, real tMin, real tMax, real& t, bool& entering, vec4& nT0, vec4& nT1) const {
 
-    double eps = 1e-6;
-    double t;
+    real eps = planeEpsilon;
     // double tMin = 0, tMax = DOUBLE_MAX;
-    vec4 nT0, nT1;
+    bool clippedMin = false;
 
     for(int i = 0; i < faces.size(); i++) {
         vec4 pIn = vec4(r.origin(), 0);
         vec4 n = vec4(faces[i].a, faces[i].b, faces[i].c, 0);
-        double dn = r.dir.dot(n);
-        double val = pIn.dot(n) + faces[i].d;
+        real dn = r.dir.dot(n);
+        real val = pIn.dot(n) + faces[i].d;
 
         if(fabs(dn) < eps) {
             if(val > eps) {
@@ -72,44 +82,120 @@ bool Polyhedron::hit(const Ray &r, double tMin, double tMax, HitRecord &rec) con
             if(t > tMin) {
                 tMin = t;
                 nT0 = n;
+                clippedMin = true;
             }
         }
     }
 
     if(tMax < tMin) return false;
 
-    bool returnTrue = false;
+    if(tMin > eps && clippedMin) {
+        t = tMin;
+        entering = true;
+        return true;
+    }
 
-    if(fabs(tMin) <= eps && (tMax >= tMin) && tMax < DBL_MAX) {
-        nT1 = (nT1 * -1.0).normalize();
-        rec.normal = vec3(nT1[0], nT1[1], nT1[2]);
-        rec.t = tMax;
-        returnTrue = true;
+    // no face clipped tMin: the origin is inside the solid (usually a secondary ray whose origin was
+    // rounded to just below the surface), so the ray hits the exit face
+    if((fabs(tMin) <= eps || (!clippedMin && tMin >= 0)) && tMax < numeric_limits<real>::max()) {
+        t = tMax;
+        entering = false;
+        return true;
     }
 
-    if(tMin > eps && tMax >= tMin) {
+    return false;
+}
+
+inline bool Polyhedron::hit(const Ray &r, real tMin, real tMax, HitRecord &rec) const {
+    vec4 nT0, nT1;
+    bool entering;
+    if(!clip(r, tMin, tMax, rec.t, entering, nT0, nT1)) return false;
+
+    if(entering) {
         nT0 = nT0.normalize();
         rec.normal = vec3(nT0[0], nT0[1], nT0[2]);
-        rec.t = tMin;
-        returnTrue = true;
+    } else {
+        nT1 = (nT1 * -1.0).normalize();
+        rec.normal = vec3(nT1[0], nT1[1], nT1[2]);
     }
 
-    if(!returnTrue) return false;
-
     rec.p = r.at(rec.t);
     rec.rayComingFromOutside = !(rec.normal.dot(r.direction()) < 0);
     rec.matPtr = matPtr;
     rec.uv = getPolyhedronUV(rec.rayComingFromOutside ? rec.normal : -rec.normal);
+    rec.footprint.uvPerUnit = 0;
+
+    return true;
+}
+
+inline bool Polyhedron::occluded(const Ray &r, real tMin, real tMax) const {
+    vec4 nT0, nT1;
+    real t;
+    bool entering;
+    return clip(r, tMin, tMax, t, entering, nT0, nT1);
+}
+
+inline bool Polyhedron::boundingBox(AABB& outputBox) const {
+    const real eps = 1e-6;
+    int n = faces.size();
+    if(n < 4) return false;
+
+    // a direction d along which the solid never ends satisfies n.d <= 0 for every face normal;
+    // if such a direction exists, one lies on the intersection line of two of the faces
+    for(int i = 0; i < n; i++) {
+        for(int j = i + 1; j < n; j++) {
+            vec3 d = vec3::cross(vec3(faces[i].a, faces[i].b, faces[i].c), vec3(faces[j].a, faces[j].b, faces[j].c));
+            if(d.nearZero()) continue;
+            d = d.normalize();
+            for(int sign = -1; sign <= 1; sign += 2) {
+                bool inside = true;
+                for(int k = 0; k < n && inside; k++) {
+                    vec3 nk = vec3(faces[k].a, faces[k].b, faces[k].c);
+                    inside = sign * nk.dot(d) <= eps * nk.length();
+                }
+                if(inside) return false;
+            }
+        }
+    }
+
+    AABB box;
+    for(int i = 0; i < n; i++) {
+        vec3 ni = vec3(faces[i].a, faces[i].b, faces[i].c);
+        for(int j = i + 1; j < n; j++) {
+            vec3 nj = vec3(faces[j].a, faces[j].b, faces[j].c);
+            for(int k = j + 1; k < n; k++) {
+                vec3 nk = vec3(faces[k].a, faces[k].b, faces[k].c);
+
+                // solve the 3x3 system ni.x = -di, nj.x = -dj, nk.x = -dk with Cramer's rule
+                vec3 njk = vec3::cross(nj, nk);
+                real det = ni.dot(njk);
+                if(fabs(det) < eps) continue;
+                p3 vertex = (-faces[i].d * njk - faces[j].d * vec3::cross(nk, ni) - faces[k].d * vec3::cross(ni, nj)) / det;
+
+                bool inside = true;
+                for(int m = 0; m < n && inside; m++) {
+                    vec3 nm = vec3(faces[m].a, faces[m].b, faces[m].c);
+                    inside = nm.dot(vertex) + faces[m].d <= 1e-4 * (nm.length() * (1.0 + vertex.length()));
+                }
+                if(inside) box.expand(vertex);
+            }
+        }
+    }
+
+    if(box.empty()) return false;
 
+    // pad the box so rays grazing a face are not culled by rounding in the vertex computation
+    real pad = 1e-4 * (1.0 + (box.maximum - box.minimum).length());
+    outputBox = AABB(box.minimum - vec3(pad, pad, pad), box.maximum + vec3(pad, pad, pad));
     return true;
 }
 
 
 // p is a point on a polyhedron of radius 1
 // Returned (u,v) is the texture coordinates for the point p on the polyhedron
-vec2 Polyhedron::getPolyhedronUV(const p3& p) {
-    double phi = atan2(-p.z(), p.x()) + pi;
-    double theta = acos(-p.y());
+inline vec2 Polyhedron::getPolyhedronUV(const p3& p) {
+    real phi = atan2(-p.z(), p.x()) + pi;
+    real theta = acos(-p.y());
     return vec2(phi / (2 * pi), theta / pi);
 }
 
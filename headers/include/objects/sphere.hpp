@@ -8,20 +8,27 @@
 class Sphere : public Hittable {
     public:
         p3 center;
-        double radius;
-        shared_ptr<Material> matPtr;
+        real radius;
+        const Material* matPtr; // non-owning, see SceneDescription::objectMaterials
 
-        Sphere(p3 center, double radius, shared_ptr<Material> m) : center(center), radius(radius), matPtr(m) {};
+        Sphere(const p3& center, real radius, const Material* m) : center(center), radius(radius), matPtr(m) {};
 
         // check ray colision with sphere
         // this function considers the vectorized sphere equation and solve it for t, t is the multiplier of the direction on the Ray's formula.
-        bool hit(const Ray& r, double tMin, double tMax, HitRecord &rec) const override;
+        bool hit(const Ray& r, real tMin, real tMax, HitRecord &rec) const override;
+
+        bool occluded(const Ray& r, real tMin, real tMax) const override;
+
+        bool boundingBox(AABB& outputBox) const override;
+
+        // fills the hit record for an intersection at distance root, shared with the SoA kernel in SphereSet
+        void fillRecord(const Ray& r, real root, HitRecord& rec) const;
 
         static vec2 getSphereUV(const p3& p);
 };
 
 
-bool Sphere::hit(const Ray &r, double tMin, double tMax, HitRecord &rec) const {
+inline bool Sphere::hit(const Ray &r, real tMin, real tMax, HitRecord &rec) const {
     p3 oc = r.origin() - center;
     auto a = r.direction().lengthSquared();
     auto halfB = oc.dot(r.direction());
@@ -31,13 +38,34 @@ bool Sphere::hit(const Ray &r, double tMin, double tMax, HitRecord &rec) const {
     if(discriminant < 0) return false;
     auto sqrtd = sqrt(discriminant);
     
-    double root = (-halfB - sqrt(discriminant)) / a;
+    real root = (-halfB - sqrtd) / a;
     // if root is out of valid range, try the second root
     if(root < tMin || root > tMax) {
-        root = (-halfB + sqrt(discriminant)) / a;
+        root = (-halfB + sqrtd) / a;
         if(root < tMin || root > tMax) return false;
     }
 
+    fillRecord(r, root, rec);
+    return true;
+}
+
+inline bool Sphere::occluded(const Ray &r, real tMin, real tMax) const {
+    p3 oc = r.origin() - center;
+    auto a = r.direction().lengthSquared();
+    auto halfB = oc.dot(r.direction());
+    auto c = oc.lengthSquared() - radius * radius;
+
+    auto discriminant = halfB * halfB - a * c;
+    if(discriminant < 0) return false;
+    auto sqrtd = sqrt(discriminant);
+
+    real root = (-halfB - sqrtd) / a;
+    if(root >= tMin && root <= tMax) return true;
+    root = (-halfB + sqrtd) / a;
+    return root >= tMin && root <= tMax;
+}
+
+inline void Sphere::fillRecord(const Ray& r, real root, HitRecord& rec) const {
     // save record of sphere hit with its normal
     rec.t = root;
     rec.p = r.at(root);
@@ -46,15 +74,22 @@ bool Sphere::hit(const Ray &r, double tMin, double tMax, HitRecord &rec) const {
     rec.normal = rec.rayComingFromOutside ? outwardNormal : -outwardNormal;
     rec.matPtr = matPtr;
     rec.uv = getSphereUV(outwardNormal);
+    // v spans the half circumference pi * r (u spans 2 pi r, faster only near the poles)
+    rec.footprint.uvPerUnit = 1 / (pi * fabs(radius));
+}
+
+inline bool Sphere::boundingBox(AABB& outputBox) const {
+    real r = fabs(radius);
+    outputBox = AABB(center - vec3(r, r, r), center + vec3(r, r, r));
     return true;
 }
 
 
 // p is a point on a sphere of radius 1
 // Returned (u,v) is the texture coordinates for the point p on the sphere
-vec2 Sphere::getSphereUV(const p3& p) {
-    double phi = atan2(-p.z(), p.x()) + pi;
-    double theta = acos(-p.y());
+inline vec2 Sphere::getSphereUV(const p3& p) {
+    real phi = atan2(-p.z(), p.x()) + pi;
+    real theta = acos(-p.y());
     return vec2(phi / (2 * pi), theta / pi);
 }
 
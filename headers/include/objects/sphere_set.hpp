@@ -0,0 +1,223 @@
+#ifndef SPHERE_SET_HPP
+#define SPHERE_SET_HPP
+
+#include "sphere.hpp"
+#include "simd.hpp"
+#include "ray_packet.hpp"
+
+// Packed structure-of-arrays copy of a group of spheres: centers and squared radii live in separate
+// 64-byte aligned arrays, so the kernel loads SimdDouble::width spheres per instruction and tests them
+// all against the ray at once, with a single sqrt per sphere and no virtual calls.
+// The kernel always works in double; with RT_SINGLE_PRECISION the winning root is rounded to real.
+//
+// The BVH keeps one SphereSet parallel to its primitive array (non-sphere slots are placeholders that
+// are never tested); it can also be used on its own as an ordinary Hittable.
+class SphereSet : public Hittable {
+    public:
+        SphereSet() { clear(); }
+
+        void clear() {
+            spheres.clear();
+            ghost.clear();
+            // the arrays always carry width extra zeroed entries so the last load never reads past the end
+            cx.assign(SimdDouble::width, 0.0);
+            cy.assign(SimdDouble::width, 0.0);
+            cz.assign(SimdDouble::width, 0.0);
+            radius2.assign(SimdDouble::width, 0.0);
+        }
+
+        // s == nullptr adds a placeholder slot
+        void add(const Sphere* s) {
+            int n = spheres.size();
+            spheres.push_back(s);
+            ghost.push_back(s != nullptr && s->matPtr != nullptr && s->matPtr->ghostMaterial);
+            cx[n] = s ? s->center.x() : 0.0;
+            cy[n] = s ? s->center.y() : 0.0;
+            cz[n] = s ? s->center.z() : 0.0;
+            radius2[n] = s ? s->radius * s->radius : 0.0;
+            cx.push_back(0.0);
+            cy.push_back(0.0);
+            cz.push_back(0.0);
+            radius2.push_back(0.0);
+        }
+
+        int size() const { return spheres.size(); }
+        const Sphere* sphere(int i) const { return spheres[i]; }
+
+        // Tests the spheres [first, first + count) and returns the index of the closest accepted hit,
+        // or -1. On a hit, tMax is lowered to its distance. Same root selection and ghost-material rule
+        // as Sphere::hit inside ComponentList::hit, with the same floating-point operations.
+        int closestHit(const Ray& r, int first, int count, real tMin, real& tMax, bool reflected) const;
+
+        // Any-hit version of closestHit for shadow rays: stops at the first group with a root in
+        // [tMin, tMax]. Ghost materials block light, as in the closest-hit shadow test.
+        bool anyHit(const Ray& r, int first, int count, real tMin, real tMax) const;
+
+        // Packet version of closestHit: the lanes hold rays instead of spheres, and each sphere of
+        // [first, first + count) is tested against all rays of laneMask. closest and best are per ray:
+        // on an accepted hit, closest[i] is lowered to its distance and best[i] set to the sphere index.
+        // Returns the mask of rays that hit some sphere.
+        int closestHitPacket(const RayPacket& packet, int laneMask, int first, int count, real tMin,
+                              double* closest, int* best, bool reflected) const;
+
+        bool hit(const Ray& r, real tMin, real tMax, HitRecord& rec) const override {
+            int i = closestHit(r, 0, size(), tMin, tMax, true);
+            if(i < 0) return false;
+            spheres[i]->fillRecord(r, tMax, rec);
+            return true;
+        }
+
+        bool occluded(const Ray& r, real tMin, real tMax) const override {
+            return anyHit(r, 0, size(), tMin, tMax);
+        }
+
+        bool boundingBox(AABB& outputBox) const override {
+            AABB box, sphereBox;
+            for(const Sphere* s : spheres) {
+                if(s && s->boundingBox(sphereBox)) box.expand(sphereBox);
+            }
+            outputBox = box;
+            return !box.empty();
+        }
+
+    private:
+        AlignedVector<double> cx, cy, cz, radius2;
+        std::vector<char> ghost;
+        std::vector<const Sphere*> spheres;
+};
+
+inline int SphereSet::closestHit(const Ray& r, int first, int count, real tMin, real& tMax, bool reflected) const {
+    const int W = SimdDouble::width;
+    const SimdDouble ox(r.orig.x()), oy(r.orig.y()), oz(r.orig.z());
+    const SimdDouble dx(r.dir.x()), dy(r.dir.y()), dz(r.dir.z());
+    const SimdDouble a(r.dir.lengthSquared());
+    const SimdDouble zero(0.0), vMin(tMin);
+
+    int best = -1;
+    double t[W];
+
+    for(int i = first; i < first + count; i += W) {
+        SimdDouble ocx = ox - SimdDouble::load(&cx[i]);
+        SimdDouble ocy = oy - SimdDouble::load(&cy[i]);
+        SimdDouble ocz = oz - SimdDouble::load(&cz[i]);
+
+        SimdDouble halfB = ocx * dx + ocy * dy + ocz * dz;
+        SimdDouble c = (ocx * ocx + ocy * ocy + ocz * ocz) - SimdDouble::load(&radius2[i]);
+        SimdDouble discriminant = halfB * halfB - a * c;
+        SimdDouble valid = discriminant >= zero;
+
+        SimdDouble sqrtd = sqrt(max(discriminant, zero));
+        SimdDouble vMax(tMax);
+        SimdDouble root1 = (-halfB - sqrtd) / a;
+        SimdDouble root2 = (-halfB + sqrtd) / a;
+        SimdDouble ok1 = (root1 >= vMin) & (root1 <= vMax);
+        SimdDouble ok2 = (root2 >= vMin) & (root2 <= vMax);
+
+        // near root when it is in range, otherwise the far one
+        SimdDouble root = SimdDouble::select(ok1, root1, root2);
+        int mask = (valid & (ok1 | ok2)).bits();
+
+        // discard lanes past the end of the range
+        int remaining = first + count - i;
+        if(remaining < W) mask &= (1 << remaining) - 1;
+        if(mask == 0) continue;
+
+        root.store(t);
+        for(int k = 0; k < W; k++) {
+            if(!(mask & (1 << k))) continue;
+            if(!reflected && ghost[i + k]) continue;
+            if((real)t[k] <= tMax) {
+                tMax = t[k];
+                best = i + k;
+            }
+        }
+    }
+
+    return best;
+}
+
+inline bool SphereSet::anyHit(const Ray& r, int first, int count, real tMin, real tMax) const {
+    const int W = SimdDouble::width;
+    const SimdDouble ox(r.orig.x()), oy(r.orig.y()), oz(r.orig.z());
+    const SimdDouble dx(r.dir.x()), dy(r.dir.y()), dz(r.dir.z());
+    const SimdDouble a(r.dir.lengthSquared());
+    const SimdDouble zero(0.0), vMin(tMin), vMax(tMax);
+
+    for(int i = first; i < first + count; i += W) {
+        SimdDouble ocx = ox - SimdDouble::load(&cx[i]);
+        SimdDouble ocy = oy - SimdDouble::load(&cy[i]);
+        SimdDouble ocz = oz - SimdDouble::load(&cz[i]);
+
+        SimdDouble halfB = ocx * dx + ocy * dy + ocz * dz;
+        SimdDouble c = (ocx * ocx + ocy * ocy + ocz * ocz) - SimdDouble::load(&radius2[i]);
+        SimdDouble discriminant = halfB * halfB - a * c;
+        SimdDouble valid = discriminant >= zero;
+
+        SimdDouble sqrtd = sqrt(max(discriminant, zero));
+        SimdDouble root1 = (-halfB - sqrtd) / a;
+        SimdDouble root2 = (-halfB + sqrtd) / a;
+        SimdDouble ok1 = (root1 >= vMin) & (root1 <= vMax);
+        SimdDouble ok2 = (root2 >= vMin) & (root2 <= vMax);
+        int mask = (valid & (ok1 | ok2)).bits();
+
+        int remaining = first + count - i;
+        if(remaining < W) mask &= (1 << remaining) - 1;
+        if(mask != 0) return true;
+    }
+
+    return false;
+}
+
+inline int SphereSet::closestHitPacket(const RayPacket& packet, int laneMask, int first, int count, real tMin,
+                                       double* closest, int* best, bool reflected) const {
+    const int W = SimdDouble::width;
+    const SimdDouble zero(0.0), vMin(tMin);
+    int hitMask = 0;
+    double t[W];
+
+    for(int j = first; j < first + count; j++) {
+        if(!reflected && ghost[j]) continue;
+        const SimdDouble cxj(cx[j]), cyj(cy[j]), czj(cz[j]), r2(radius2[j]);
+
+        for(int i = 0; i < packet.padded; i += W) {
+            int lanes = (laneMask >> i) & ((1 << W) - 1);
+            if(lanes == 0) continue;
+
+            SimdDouble dx = SimdDouble::load(&packet.dx[i]);
+            SimdDouble dy = SimdDouble::load(&packet.dy[i]);
+            SimdDouble dz = SimdDouble::load(&packet.dz[i]);
+            SimdDouble a = SimdDouble::load(&packet.a[i]);
+            SimdDouble ocx = SimdDouble::load(&packet.ox[i]) - cxj;
+            SimdDouble ocy = SimdDouble::load(&packet.oy[i]) - cyj;
+            SimdDouble ocz = SimdDouble::load(&packet.oz[i]) - czj;
+
+            SimdDouble halfB = ocx * dx + ocy * dy + ocz * dz;
+            SimdDouble c = (ocx * ocx + ocy * ocy + ocz * ocz) - r2;
+            SimdDouble discriminant = halfB * halfB - a * c;
+            SimdDouble valid = discriminant >= zero;
+
+            SimdDouble sqrtd = sqrt(max(discriminant, zero));
+            SimdDouble vMax = SimdDouble::load(&closest[i]);
+            SimdDouble root1 = (-halfB - sqrtd) / a;
+            SimdDouble root2 = (-halfB + sqrtd) / a;
+            SimdDouble ok1 = (root1 >= vMin) & (root1 <= vMax);
+            SimdDouble ok2 = (root2 >= vMin) & (root2 <= vMax);
+            SimdDouble root = SimdDouble::select(ok1, root1, root2);
+            int accepted = (valid & (ok1 | ok2)).bits() & lanes;
+            if(accepted == 0) continue;
+
+            root.store(t);
+            for(int k = 0; k < W; k++) {
+                if(accepted & (1 << k)) {
+                    closest[i + k] = (real)t[k];
+                    best[i + k] = j;
+                }
+            }
+            hitMask |= accepted << i;
+        }
+    }
+
+    return hitMask;
+}
+
+#endif // !SPHERE_SET_HPP
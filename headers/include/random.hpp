@@ -0,0 +1,71 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+
+// Gerador xoshiro256+ com estado próprio de cada thread.
+// Substitui rand(), que usa um lock global na glibc e serializava as threads de renderização.
+// O renderizador ressemeia o gerador a cada amostra de cada pixel (ver seedFor), de modo que a
+// imagem depende apenas da semente e não da quantidade de threads ou da ordem de execução.
+class Random {
+    public:
+        // Estado completo do gerador, para salvar e restaurar a sequência de uma amostra
+        struct State {
+            uint64_t s[4];
+        };
+
+        static void seed(uint64_t value) {
+            uint64_t x = value;
+            for(int i = 0; i < 4; i++) {
+                state.s[i] = splitMix64(x);
+            }
+        }
+
+        // Semente derivada de (semente da cena, pixel, amostra), independente entre si
+        static void seedFor(uint64_t sceneSeed, uint64_t pixel, uint64_t sample) {
+            uint64_t x = sceneSeed;
+            uint64_t h = splitMix64(x) ^ pixel;
+            h = splitMix64(h) ^ sample;
+            seed(h);
+        }
+
+        static State getState() { return state; }
+        static void setState(const State& st) { state = st; }
+
+        static uint64_t next() {
+            uint64_t* s = state.s;
+            const uint64_t result = s[0] + s[3];
+            const uint64_t t = s[1] << 17;
+
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+
+            return result;
+        }
+
+        // [0,1) com 53 bits de mantissa
+        static double nextDouble() {
+            return (next() >> 11) * 0x1.0p-53;
+        }
+
+    private:
+        inline static thread_local State state = {{0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL,
+                                                   0x94d049bb133111ebULL, 0x2545f4914f6cdd1dULL}};
+
+        static uint64_t rotl(const uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        static uint64_t splitMix64(uint64_t& x) {
+            uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+};
+
+#endif // !RANDOM_HPP
@@ -14,7 +14,7 @@ class Ray {
         p3 origin() const { return orig; }
         v3 direction() const { return dir; }
 
-        p3 at(double t) const {
+        p3 at(real t) const {
             return orig + t * dir;
         }
 };
@@ -0,0 +1,50 @@
+#ifndef RAY_PACKET_HPP
+#define RAY_PACKET_HPP
+
+#include "ray.hpp"
+#include "simd.hpp"
+
+// Pacote de raios primários em estrutura de arrays: cada componente de origem e direção fica num
+// array próprio, de modo que SimdDouble::width raios são testados por instrução contra a mesma
+// caixa da BVH ou a mesma esfera. Os raios de um pacote são as amostras de um mesmo pixel, que
+// saem quase do mesmo ponto na mesma direção e por isso percorrem praticamente os mesmos nós.
+struct RayPacket {
+    static constexpr int maxSize = 16;
+
+    int size = 0;
+    int padded = 0; // size arredondado para múltiplo de SimdDouble::width, ver finish
+    Ray rays[maxSize];
+
+    alignas(64) double ox[maxSize], oy[maxSize], oz[maxSize];
+    alignas(64) double dx[maxSize], dy[maxSize], dz[maxSize];
+    alignas(64) double invX[maxSize], invY[maxSize], invZ[maxSize];
+    alignas(64) double a[maxSize]; // |dir|², como em Sphere::hit
+
+    void clear() { size = padded = 0; }
+
+    void add(const Ray& r) {
+        int i = size++;
+        rays[i] = r;
+        ox[i] = r.orig.x(); oy[i] = r.orig.y(); oz[i] = r.orig.z();
+        dx[i] = r.dir.x(); dy[i] = r.dir.y(); dz[i] = r.dir.z();
+        invX[i] = 1.0 / r.dir.x(); invY[i] = 1.0 / r.dir.y(); invZ[i] = 1.0 / r.dir.z();
+        a[i] = r.dir.lengthSquared();
+    }
+
+    // Completa as posições até padded (usadas pelos laços SIMD) repetindo o raio 0; os resultados
+    // dessas posições são descartados pela máscara de validMask. Chamar depois do último add.
+    void finish() {
+        padded = (size + SimdDouble::width - 1) / SimdDouble::width * SimdDouble::width;
+        for(int i = size; i < padded; i++) {
+            ox[i] = ox[0]; oy[i] = oy[0]; oz[i] = oz[0];
+            dx[i] = dx[0]; dy[i] = dy[0]; dz[i] = dz[0];
+            invX[i] = invX[0]; invY[i] = invY[0]; invZ[i] = invZ[0];
+            a[i] = a[0];
+        }
+    }
+
+    // Bit i ligado para cada raio válido
+    int validMask() const { return (1 << size) - 1; }
+};
+
+#endif // !RAY_PACKET_HPP
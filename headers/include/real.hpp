@@ -0,0 +1,26 @@
+#ifndef REAL_HPP
+#define REAL_HPP
+
+// Tipo escalar da geometria (vetores, raios, interseções e caixas envolventes), escolhido na
+// compilação: double por padrão, float com -DRT_SINGLE_PRECISION (make PRECISION=float).
+// Em float os vetores ocupam metade da memória e cabem o dobro de valores por registrador SIMD,
+// mas as tolerâncias geométricas precisam acompanhar a precisão menor.
+#ifdef RT_SINGLE_PRECISION
+typedef float real;
+
+// Distância mínima ao longo do raio para aceitar uma interseção (evita que o raio refletido ou de
+// sombra acerte a própria superfície de onde saiu)
+const real rayEpsilon = 0.01f;
+// Tolerância de Polyhedron para considerar o raio paralelo a uma face
+const real planeEpsilon = 1e-6f;
+// Limite de vec3::nearZero
+const real nearZeroEpsilon = 1e-6f;
+#else
+typedef double real;
+
+const real rayEpsilon = 0.001;
+const real planeEpsilon = 1e-6;
+const real nearZeroEpsilon = 1e-8;
+#endif
+
+#endif // !REAL_HPP
@@ -7,36 +7,89 @@
 #include "camera.hpp"
 #include "objects/hittable.hpp"
 #include "materials/light_material.hpp"
+#include "thread_pool.hpp"
+#include "image_writer.hpp"
+#include "framebuffer.hpp"
+#include <atomic>
 #include <string>
 
+// Bloco retangular da imagem (intervalos inclusivos) processado por uma tarefa do pool
+struct Tile {
+    int rowFrom, rowTo;
+    int colFrom, colTo;
+};
+
+// Primeira interseção de um raio já calculada fora de rayColor (pelo pacote de raios primários)
+struct PrimaryHit {
+    bool hit;
+    HitRecord rec;
+};
+
 // Classe responsável por renderizar uma cena e gerar a imagem final
 class Renderer {
 public:
-    // Renderiza a cena e salva no arquivo de saída especificado
-    static void render(const SceneDescription& scene, const std::string& outputFile);
+    // Renderiza a cena e salva no arquivo de saída especificado. Retorna falso se a imagem ou o
+    // ponto de controle não puderem ser lidos ou gravados.
+    static bool render(const SceneDescription& scene, const std::string& outputFile);
+    
+    // Igual ao anterior, mas usa um pool de threads já existente. Várias cenas podem ser renderizadas
+    // ao mesmo tempo no mesmo pool, cada uma numa thread chamadora (ver o modo --batch de main.cpp).
+    static bool render(const SceneDescription& scene, const std::string& outputFile, ThreadPool& pool);
+    
+    // Renderiza a cena com todas as amostras em fb (que deve ter as dimensões da imagem e estar
+    // limpo), sem gravar arquivo. Usado pela animação, que grava os quadros em outra thread.
+    static void renderFrame(const SceneDescription& scene, Framebuffer& fb, ThreadPool& pool);
+    
+    // Renderiza com todas as amostras só as linhas [rowFrom, rowTo] de fb, sem gravar arquivo. rowFrom
+    // deve ser múltiplo de tileSize. Usado pelos processos da renderização distribuída.
+    static void renderRows(const SceneDescription& scene, Framebuffer& fb, int rowFrom, int rowTo, ThreadPool& pool);
+    
+    // Grava em outputFile a imagem de fb, já com todas as amostras, e, na amostragem adaptativa, o
+    // resumo e o mapa de amostras
+    static bool write(const SceneDescription& scene, const Framebuffer& fb, const std::string& outputFile);
+    
+    // Raios traçados (primários, secundários e de sombra) por todas as renderizações do processo
+    static uint64_t raysTraced() { return totalRays; }
+    
+    static const int tileSize = 16;        // Lado dos blocos distribuídos entre as threads
     
 private:
+    static std::atomic<uint64_t> totalRays;
+    
     // Constantes de renderização
-    static const int maxDepth = 14;        // Profundidade máxima de recursão do ray tracing
     static const bool smoothShadow = true; // Habilita sombras suaves
     
-    // Variáveis de controle de progresso
-    static int remainingRows;
-    
-    // Métodos auxiliares de renderização
+    // Métodos auxiliares de renderização. pixelSpread é o ângulo de um pixel (abertura do cone dos raios).
+    // Com primary, a primeira interseção de r não é recalculada.
     static color rayColor(const Ray& r, const ComponentList& componentList, 
-                         const std::vector<Light>& lights, int maxDep, color bg);
+                         const std::vector<Light>& lights, int maxDepth, int rouletteDepth, const color& bg,
+                         double pixelSpread, const PrimaryHit* primary = nullptr);
     
-    static void lightMultiplier(const Ray& r, HitRecord hr, 
+    static void lightMultiplier(const Ray& r, const HitRecord& hr, 
                                const std::vector<Light>& lights,
                                v3& diffuseColor, v3& specularColor,
                                const ComponentList& componentList);
     
-    static void computeFor(int rowFrom, int rowTo, color** img, int imgWidth, int imgHeight,
-                          int samplesPerPixel, const Camera& camera, 
-                          const ComponentList& componentList, const std::vector<Light>& lights);
+    // Uma passada: leva os pixels das linhas [rowFrom, rowTo] a target amostras e grava a imagem em
+    // outputFile (se não for vazio; só com a imagem inteira). A imagem é gravada num arquivo temporário
+    // renomeado por cima de outputFile no fim da passada: interromper uma passada não destrói a imagem
+    // da passada anterior.
+    static bool renderPass(const SceneDescription& scene, const Camera& camera, Framebuffer& fb, int target,
+                           const std::string& outputFile, ThreadPool& pool, int rowFrom, int rowTo);
+    
+    // Leva os pixels do bloco a target amostras (na amostragem adaptativa, no máximo target)
+    static void computeFor(const Tile& tile, Framebuffer& fb, const SceneDescription& scene,
+                          const Camera& camera, int target);
+    
+    // Traça as amostras [first, first + count) do pixel, agrupadas em pacotes de scene.packetSize raios
+    static void samplePixel(int row, int col, int first, int count, Framebuffer& fb,
+                            const SceneDescription& scene, const Camera& camera);
+    
+    // Amostragem adaptativa: mostra a média de amostras por pixel e grava o mapa de calor; false se
+    // o mapa não pôde ser gravado
+    static bool reportSamples(const Framebuffer& fb, const SceneDescription& scene);
     
-    static void printRemaining();
+    static void printRemaining(int remainingTiles);
 };
 
 #endif
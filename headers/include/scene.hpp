@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <string>
 
 // Includes necessários para a estrutura
 #include "vectors/vec3.hpp"
@@ -11,6 +13,7 @@
 #include "component_list.hpp"
 #include "textures/texture.hpp"
 #include "materials/generic_material.hpp"
+#include "image_writer.hpp"
 
 // Estrutura que agrupa todos os dados de uma cena para renderização
 // Elimina a necessidade de variáveis globais
@@ -27,13 +30,36 @@ struct SceneDescription {
     std::vector<Light> lights;
     std::vector<TexturePtr> pigments;
     std::vector<std::shared_ptr<GenericMaterial>> materials;
+    
+    // Tabela dona dos materiais usados pelos objetos (material da cena combinado com um pigmento).
+    // Objetos e HitRecord guardam apenas ponteiros para estas entradas, sem contagem de referências.
+    std::vector<MaterialPtr> objectMaterials;
     ComponentList componentList;
     
+    // Hash dos registros da cena (ver SceneFile::hash): identifica a cena nos pontos de controle e na
+    // renderização distribuída, igual para a mesma cena em formato texto ou binário
+    uint64_t sceneHash;
+    
     // Parâmetros de renderização
     int imgWidth;
     int imgHeight;
     double aspectRatio;
     int samplesPerPixel;
+    double noiseThreshold;  // Amostragem adaptativa: erro padrão aceito por pixel (0 = desligada)
+    int minSamples;         // Amostras mínimas e máximas por pixel na amostragem adaptativa
+    int maxSamples;
+    std::string heatmapFile; // Mapa de amostras por pixel da amostragem adaptativa (vazio = não grava)
+    int passSamples;        // Renderização progressiva: amostras por pixel em cada passada (0 = uma só)
+    std::string checkpointFile; // Ponto de controle gravado entre as passadas (vazio = não grava)
+    double checkpointInterval;  // Segundos mínimos entre duas gravações do ponto de controle
+    std::string resumeFile;     // Ponto de controle de onde a renderização continua (vazio = do zero)
+    int maxDepth;           // Número máximo de interações por caminho
+    int rouletteDepth;      // Interações antes de a roleta russa começar a encerrar caminhos
+    uint64_t seed;          // Semente do gerador aleatório (mesma semente, mesma imagem)
+    int threads;            // Threads de renderização (0 = número de núcleos)
+    int packetSize;         // Raios primários traçados juntos por pacote (0 ou 1 = um raio por vez)
+    ImageFormat outputFormat; // Formato do arquivo de saída
+    bool showProgress;      // Mostra em cerr os blocos restantes de cada passada
     
     // Construtor com valores padrão
     SceneDescription() 
@@ -43,10 +69,23 @@ struct SceneDescription {
           vFov(50),
           aperture(0.00),
           distToFocus(10.0),
+          sceneHash(0),
           imgWidth(800),
           imgHeight(600),
           aspectRatio(4.0 / 3.0),
-          samplesPerPixel(15)
+          samplesPerPixel(15),
+          noiseThreshold(0),
+          minSamples(4),
+          maxSamples(15),
+          passSamples(0),
+          checkpointInterval(0),
+          maxDepth(14),
+          rouletteDepth(3),
+          seed(0),
+          threads(0),
+          packetSize(8),
+          outputFormat(ImageFormat::PPM_BINARY),
+          showProgress(true)
     {}
 };
 
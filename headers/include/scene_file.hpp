@@ -0,0 +1,136 @@
+#ifndef SCENE_FILE_HPP
+#define SCENE_FILE_HPP
+
+#include "scene.hpp"
+#include "bvh.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Registros da descrição de uma cena, em forma de dados simples de tamanho fixo. São o que o leitor do
+// formato texto produz (InputProcessor) e exatamente o que o arquivo de cena binário guarda, de modo que
+// as duas entradas passam pela mesma montagem (SceneFile::instantiate) e geram a mesma cena.
+struct CameraRecord {
+    double lookFrom[3] = {13, 2, 3};
+    double lookAt[3] = {0, 0, 0};
+    double vUp[3] = {0, 1, 0};
+    double vFov = 50;
+    double aperture = 0;
+    double distToFocus = 10;
+};
+
+struct LightRecord {
+    double position[3];
+    double color[3];
+    double attenuation[3]; // constante, linear e quadrática
+};
+
+enum class PigmentType : uint32_t { Solid = 0, Checker = 1, Image = 2 };
+
+struct PigmentRecord {
+    PigmentType type;
+    uint32_t nameOffset;   // Image: nome do arquivo, em SceneView::names
+    uint32_t nameLength;
+    uint32_t reserved;
+    double color1[3];      // Solid: a cor; Checker: as duas cores
+    double color2[3];
+    double size;           // Checker: tamanho das casas
+    double p0[4], p1[4];   // Image: planos de mapeamento
+};
+
+struct MaterialRecord {
+    double ka, kd, ks, alpha; // ambiente, difusa, especular e expoente especular
+    double kr, kt, ior;       // reflexão, transmissão e índice de refração
+    double fuzz;
+};
+
+enum class ObjectType : uint32_t { Sphere = 0, Polyhedron = 1 };
+
+struct ObjectRecord {
+    ObjectType type;
+    int32_t pigment;
+    int32_t material;
+    uint32_t faceFirst;    // Polyhedron: faces em SceneView::faces
+    uint32_t faceCount;
+    uint32_t reserved;
+    double sphere[4];      // Sphere: centro e raio
+};
+
+struct FaceRecord {
+    double a, b, c, d;     // plano ax + by + cz + d = 0
+};
+
+// Intervalo de registros contíguos, dentro de um SceneData ou direto do arquivo mapeado em memória
+template<typename T>
+struct RecordSpan {
+    const T* data = nullptr;
+    size_t count = 0;
+
+    const T& operator[](size_t i) const { return data[i]; }
+    size_t size() const { return count; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+};
+
+// Cena completa sem cópia: ponteiros para os registros
+struct SceneView {
+    CameraRecord camera;
+    RecordSpan<LightRecord> lights;
+    RecordSpan<PigmentRecord> pigments;
+    RecordSpan<MaterialRecord> materials;
+    RecordSpan<ObjectRecord> objects;
+    RecordSpan<FaceRecord> faces;
+    std::string_view names;
+    RecordSpan<BVHBakedNode> bvhNodes;  // vazios quando a BVH não foi gravada
+    RecordSpan<uint32_t> bvhOrder;
+};
+
+// Dona dos registros, preenchida pelo leitor do formato texto
+struct SceneData {
+    CameraRecord camera;
+    std::vector<LightRecord> lights;
+    std::vector<PigmentRecord> pigments;
+    std::vector<MaterialRecord> materials;
+    std::vector<ObjectRecord> objects;
+    std::vector<FaceRecord> faces;
+    std::string names;
+
+    SceneView view() const;
+};
+
+// Arquivo de cena binário (.rtscene). Um cabeçalho de tamanho fixo (identificador, versão, câmera e a
+// posição e quantidade de cada seção) seguido das seções, alinhadas a 8 bytes: luzes, pigmentos,
+// materiais, objetos, faces, nomes de arquivo e, opcionalmente, a topologia da BVH já construída. Tudo
+// na ordem de bytes da máquina. Na carga o arquivo é mapeado em memória e os registros são lidos no
+// próprio mapeamento; com a BVH gravada, a construção SAH também é evitada.
+class SceneFile {
+    public:
+        static const char magic[8];
+        static const uint32_t version = 1;
+
+        // Verdadeiro se o conteúdo começa com o identificador do formato binário
+        static bool isBinary(std::string_view contents);
+
+        // Aponta view para os registros de contents, verificando que todas as seções e índices estão
+        // dentro do arquivo. Mensagens de erro vão para cerr.
+        static bool read(std::string_view contents, SceneView& view);
+
+        // Grava os registros e, se bvh não for nulo e estiver construído, a topologia da sua BVH
+        static bool write(const std::string& path, const SceneData& data, const ComponentList* bvh);
+
+        // Cria luzes, pigmentos, materiais e objetos da cena a partir dos registros e constrói a BVH
+        // (com a topologia gravada, se houver e for válida). Preenche também scene.sceneHash.
+        static void instantiate(const SceneView& view, SceneDescription& scene);
+
+        // Hash FNV-1a de 64 bits da câmera e dos registros da cena (sem a BVH gravada, que não muda
+        // a imagem)
+        static uint64_t hash(const SceneView& view);
+
+        // Conversão entre o registro da câmera e os parâmetros de câmera da cena (usada também pela
+        // animação, que troca só a câmera entre os quadros)
+        static void applyCamera(const CameraRecord& camera, SceneDescription& scene);
+        static CameraRecord camera(const SceneDescription& scene);
+};
+
+#endif // !SCENE_FILE_HPP
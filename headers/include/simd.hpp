@@ -0,0 +1,199 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#include "real.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Camada mínima sobre as instruções vetoriais do processador, usada pelos kernels que testam
+// vários objetos por instrução. A largura é escolhida em tempo de compilação:
+//   AVX/AVX2 (-mavx2 ou -march=native): 4 doubles por registrador
+//   SSE2 (padrão em x86-64):            2 doubles por registrador
+//   outros processadores:               1 (código escalar)
+// Os kernels são escritos uma única vez sobre SimdDouble e funcionam em qualquer largura.
+
+#if defined(__AVX__)
+#include <immintrin.h>
+
+struct SimdDouble {
+    static const int width = 4;
+    __m256d v;
+
+    SimdDouble() {}
+    SimdDouble(__m256d v) : v(v) {}
+    explicit SimdDouble(double x) : v(_mm256_set1_pd(x)) {}
+
+    static SimdDouble load(const double* p) { return _mm256_loadu_pd(p); }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+
+    friend SimdDouble operator+(SimdDouble a, SimdDouble b) { return _mm256_add_pd(a.v, b.v); }
+    friend SimdDouble operator-(SimdDouble a, SimdDouble b) { return _mm256_sub_pd(a.v, b.v); }
+    friend SimdDouble operator*(SimdDouble a, SimdDouble b) { return _mm256_mul_pd(a.v, b.v); }
+    friend SimdDouble operator/(SimdDouble a, SimdDouble b) { return _mm256_div_pd(a.v, b.v); }
+    friend SimdDouble operator&(SimdDouble a, SimdDouble b) { return _mm256_and_pd(a.v, b.v); }
+    friend SimdDouble operator|(SimdDouble a, SimdDouble b) { return _mm256_or_pd(a.v, b.v); }
+
+    friend SimdDouble sqrt(SimdDouble a) { return _mm256_sqrt_pd(a.v); }
+    friend SimdDouble max(SimdDouble a, SimdDouble b) { return _mm256_max_pd(a.v, b.v); }
+
+    // Comparações devolvem máscaras (todos os bits da faixa em 1 quando verdadeiro)
+    friend SimdDouble operator>=(SimdDouble a, SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+    friend SimdDouble operator<=(SimdDouble a, SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+    friend SimdDouble operator>(SimdDouble a, SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+    friend SimdDouble operator<(SimdDouble a, SimdDouble b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+
+    // Troca o sinal (inclusive de zeros), como o - unário escalar
+    SimdDouble operator-() const { return _mm256_xor_pd(v, _mm256_set1_pd(-0.0)); }
+
+    // mask ? a : b, faixa a faixa
+    static SimdDouble select(SimdDouble mask, SimdDouble a, SimdDouble b) { return _mm256_blendv_pd(b.v, a.v, mask.v); }
+
+    // Bit i ligado quando a faixa i da máscara é verdadeira
+    int bits() const { return _mm256_movemask_pd(v); }
+};
+
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+
+struct SimdDouble {
+    static const int width = 2;
+    __m128d v;
+
+    SimdDouble() {}
+    SimdDouble(__m128d v) : v(v) {}
+    explicit SimdDouble(double x) : v(_mm_set1_pd(x)) {}
+
+    static SimdDouble load(const double* p) { return _mm_loadu_pd(p); }
+    void store(double* p) const { _mm_storeu_pd(p, v); }
+
+    friend SimdDouble operator+(SimdDouble a, SimdDouble b) { return _mm_add_pd(a.v, b.v); }
+    friend SimdDouble operator-(SimdDouble a, SimdDouble b) { return _mm_sub_pd(a.v, b.v); }
+    friend SimdDouble operator*(SimdDouble a, SimdDouble b) { return _mm_mul_pd(a.v, b.v); }
+    friend SimdDouble operator/(SimdDouble a, SimdDouble b) { return _mm_div_pd(a.v, b.v); }
+    friend SimdDouble operator&(SimdDouble a, SimdDouble b) { return _mm_and_pd(a.v, b.v); }
+    friend SimdDouble operator|(SimdDouble a, SimdDouble b) { return _mm_or_pd(a.v, b.v); }
+
+    friend SimdDouble sqrt(SimdDouble a) { return _mm_sqrt_pd(a.v); }
+    friend SimdDouble max(SimdDouble a, SimdDouble b) { return _mm_max_pd(a.v, b.v); }
+
+    friend SimdDouble operator>=(SimdDouble a, SimdDouble b) { return _mm_cmpge_pd(a.v, b.v); }
+    friend SimdDouble operator<=(SimdDouble a, SimdDouble b) { return _mm_cmple_pd(a.v, b.v); }
+    friend SimdDouble operator>(SimdDouble a, SimdDouble b) { return _mm_cmpgt_pd(a.v, b.v); }
+    friend SimdDouble operator<(SimdDouble a, SimdDouble b) { return _mm_cmplt_pd(a.v, b.v); }
+
+    SimdDouble operator-() const { return _mm_xor_pd(v, _mm_set1_pd(-0.0)); }
+
+    // SSE2 não tem blend: (mask & a) | (~mask & b)
+    static SimdDouble select(SimdDouble mask, SimdDouble a, SimdDouble b) {
+        return _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v));
+    }
+
+    int bits() const { return _mm_movemask_pd(v); }
+};
+
+#else
+
+struct SimdDouble {
+    static const int width = 1;
+    double v;
+    bool mask = false;
+
+    SimdDouble() {}
+    explicit SimdDouble(double x) : v(x) {}
+
+    static SimdDouble load(const double* p) { return SimdDouble(*p); }
+    void store(double* p) const { *p = v; }
+
+    static SimdDouble fromMask(bool m) { SimdDouble r(0.0); r.mask = m; return r; }
+
+    friend SimdDouble operator+(SimdDouble a, SimdDouble b) { return SimdDouble(a.v + b.v); }
+    friend SimdDouble operator-(SimdDouble a, SimdDouble b) { return SimdDouble(a.v - b.v); }
+    friend SimdDouble operator*(SimdDouble a, SimdDouble b) { return SimdDouble(a.v * b.v); }
+    friend SimdDouble operator/(SimdDouble a, SimdDouble b) { return SimdDouble(a.v / b.v); }
+    friend SimdDouble operator&(SimdDouble a, SimdDouble b) { return fromMask(a.mask && b.mask); }
+    friend SimdDouble operator|(SimdDouble a, SimdDouble b) { return fromMask(a.mask || b.mask); }
+
+    friend SimdDouble sqrt(SimdDouble a) { return SimdDouble(std::sqrt(a.v)); }
+    friend SimdDouble max(SimdDouble a, SimdDouble b) { return SimdDouble(a.v > b.v ? a.v : b.v); }
+
+    friend SimdDouble operator>=(SimdDouble a, SimdDouble b) { return fromMask(a.v >= b.v); }
+    friend SimdDouble operator<=(SimdDouble a, SimdDouble b) { return fromMask(a.v <= b.v); }
+    friend SimdDouble operator>(SimdDouble a, SimdDouble b) { return fromMask(a.v > b.v); }
+    friend SimdDouble operator<(SimdDouble a, SimdDouble b) { return fromMask(a.v < b.v); }
+
+    SimdDouble operator-() const { return SimdDouble(-v); }
+
+    static SimdDouble select(SimdDouble mask, SimdDouble a, SimdDouble b) { return mask.mask ? a : b; }
+
+    int bits() const { return mask ? 1 : 0; }
+};
+
+#endif
+
+// Quatro valores real operados juntos, base de vec3 e vec4. Diferente de SimdDouble, a largura é
+// fixa em 4. Quando cabem num registrador (4 floats em SSE, 4 doubles em AVX) é um vetor nativo
+// das extensões do GCC/Clang. Sem AVX, 4 doubles viram dois vetores de 2: o vetor de 32 bytes
+// genérico faria o GCC passar cada resultado pela pilha.
+// yzx e zxy permutam os três primeiros componentes (usados em vec3::cross).
+#if defined(RT_SINGLE_PRECISION) || defined(__AVX__)
+typedef real real4 __attribute__((vector_size(4 * sizeof(real))));
+
+inline real4 yzx(const real4& v) { return __builtin_shufflevector(v, v, 1, 2, 0, 3); }
+inline real4 zxy(const real4& v) { return __builtin_shufflevector(v, v, 2, 0, 1, 3); }
+
+#else
+typedef double real2 __attribute__((vector_size(2 * sizeof(double))));
+
+struct real4 {
+    real2 lo, hi;
+
+    real4() {}
+    real4(const real2& lo, const real2& hi) : lo(lo), hi(hi) {}
+    real4(double c0, double c1, double c2, double c3) : lo(real2{c0, c1}), hi(real2{c2, c3}) {}
+
+    double operator[](int i) const { return i < 2 ? lo[i] : hi[i - 2]; }
+
+    real4 operator-() const { return real4(-lo, -hi); }
+    real4& operator+=(const real4& u) { lo += u.lo; hi += u.hi; return *this; }
+    real4& operator*=(double t) { lo *= t; hi *= t; return *this; }
+
+    friend real4 operator+(const real4& a, const real4& b) { return real4(a.lo + b.lo, a.hi + b.hi); }
+    friend real4 operator-(const real4& a, const real4& b) { return real4(a.lo - b.lo, a.hi - b.hi); }
+    friend real4 operator*(const real4& a, const real4& b) { return real4(a.lo * b.lo, a.hi * b.hi); }
+    friend real4 operator/(const real4& a, const real4& b) { return real4(a.lo / b.lo, a.hi / b.hi); }
+    friend real4 operator*(const real4& a, double t) { return real4(a.lo * t, a.hi * t); }
+    friend real4 operator/(const real4& a, double t) { return real4(a.lo / t, a.hi / t); }
+};
+
+inline real4 yzx(const real4& v) { return real4(v[1], v[2], v[0], v[3]); }
+inline real4 zxy(const real4& v) { return real4(v[2], v[0], v[1], v[3]); }
+#endif
+
+// Alocador de std::vector alinhado a 64 bytes (linha de cache e largura máxima de registrador)
+template<class T>
+struct AlignedAllocator {
+    typedef T value_type;
+    static const size_t alignment = 64;
+
+    AlignedAllocator() {}
+    template<class U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = ((n * sizeof(T) + alignment - 1) / alignment) * alignment;
+        void* p = aligned_alloc(alignment, bytes > 0 ? bytes : alignment);
+        if(!p) throw std::bad_alloc();
+        return (T*)p;
+    }
+
+    void deallocate(T* p, size_t) { free(p); }
+
+    template<class U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template<class U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template<class T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+#endif // !SIMD_HPP
@@ -0,0 +1,62 @@
+#ifndef TEXT_READER_HPP
+#define TEXT_READER_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Arquivo inteiro mapeado em memória, somente leitura. O conteúdo é lido direto das páginas do
+// arquivo, sem cópia para um buffer do programa.
+class MappedFile {
+    public:
+        MappedFile() {}
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        std::string_view contents() const { return std::string_view(data, length); }
+
+    private:
+        const char* data = nullptr;
+        size_t length = 0;
+};
+
+// Leitura de um texto linha a linha e, dentro da linha, token a token (separados por espaços),
+// com os números convertidos por std::from_chars. Nenhuma alocação: os tokens são string_view
+// apontando para o próprio texto. Erros de formato lançam std::runtime_error com o número da linha.
+class TextReader {
+    public:
+        explicit TextReader(std::string_view text)
+            : cur(text.data()), lineEnd(text.data()), next(text.data()), end(text.data() + text.size()) {}
+
+        // Avança para a próxima linha; falso no fim do texto
+        bool nextLine();
+
+        // Verdadeiro se ainda há tokens na linha atual
+        bool hasMore();
+
+        // Próximo token da linha atual
+        std::string_view word();
+
+        // Próximo token convertido. Como stod/stoi, aceitam um prefixo numérico do token.
+        double number();
+        int integer();
+
+        int lineNumber() const { return line; }
+
+    private:
+        const char* cur;     // posição na linha atual
+        const char* lineEnd; // fim da linha atual (sem o '\n')
+        const char* next;    // início da próxima linha
+        const char* end;
+        int line = 0;
+
+        void skipSpaces();
+        [[noreturn]] void fail(const char* expected, std::string_view found) const;
+};
+
+#endif // !TEXT_READER_HPP
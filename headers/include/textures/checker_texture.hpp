@@ -19,9 +19,9 @@ class CheckerTexture : public Texture {
             scale = pi / s;
         }
 
-        virtual color value(vec2 uv, const p3& p) const override {
+        virtual color value(vec2 uv, const p3& p, const Footprint& footprint) const override {
             double sines = sin(scale * p.x()) * sin(scale * p.y()) * sin(scale * p.z());
-            return (sines < 0 ? odd : even)->value(uv, p);
+            return (sines < 0 ? odd : even)->value(uv, p, footprint);
         }
 };
 typedef shared_ptr<CheckerTexture> CheckerTexturePtr;
@@ -3,58 +3,30 @@
 
 #include "../common.hpp"
 #include "texture.hpp"
-#include "v_stb_image.h"
+#include "texture_cache.hpp"
 
 using namespace std;
 
 class ImageTexture : public Texture {
 
     private:
-        unsigned char *data;
-        int width, height;
-        int bytesPerScanline;
+        TextureImagePtr image;
 
     public: 
-        const static int bytesPerPixel = 3;
+        ImageTexture() {}
 
-        ImageTexture() : data(NULL), width(0), height(0), bytesPerScanline(0) {}
+        // The decoded file is shared with every other texture that uses it (see TextureCache)
+        ImageTexture(const char* filename) : image(TextureCache::load(filename)) {}
 
-        ImageTexture(const char* filename) {
-            int componentsPerPixel = bytesPerPixel;
-
-            data = stbi_load(filename, &width, &height, &componentsPerPixel, componentsPerPixel);
-            if(!data) {
-                cerr << "Could not load texture file " << filename << endl;
-                height = 0;
-                width = 0;
-                return;
-            }
-            cout << filename << ": " << width << " " << height << endl;
-
-            bytesPerScanline = bytesPerPixel * width;
-        }
-
-        ~ImageTexture() {
-            delete data;
-        }
-
-        virtual color value(vec2 uv, const vec3& p) const override {
-            if(data == NULL) return color(0, 0, 0);
+        virtual color value(vec2 uv, const vec3& p, const Footprint& footprint) const override {
+            if(!image) return color(0, 0, 0);
 
             double u = clamp(uv.u(), 0.0, 1.0);
             // Flip v to image coordinates
             double v = 1.0 - clamp(uv.v(), 0.0, 1.0);
 
-            int i = (int)(u * width);
-            int j = (int)(v * height);
-            
-            if(i >= width) i = width - 1;
-            if(j >= height) j = height - 1;
-
-            const double colorScale = 1.0 / 255.0;
-            auto pixel = data + j*bytesPerScanline + i*bytesPerPixel;
-
-            return color(colorScale * pixel[0], colorScale * pixel[1], colorScale * pixel[2]);
+            double texels = footprint.width * footprint.uvPerUnit * max(image->width(), image->height());
+            return image->sample(u, v, texels, TextureCache::filter());
         }
 
 };
@@ -2,7 +2,7 @@
 #define IMAGE_TEXTUREPS_HPP
 
 #include "texture.hpp"
-#include "v_stb_image.h"
+#include "texture_cache.hpp"
 #include "vec4.hpp"
 
 using namespace std;
@@ -11,54 +11,28 @@ using namespace std;
 class ImageTexturePs : public Texture {
 
     private:
-        unsigned char *data;
-        int width, height;
-        int bytesPerScanline;
+        TextureImagePtr image;
 
         vec4 P0, P1;
 
     public: 
-        const static int bytesPerPixel = 3;
+        ImageTexturePs() : P0(vec4()), P1(vec4()) {}
 
-        ImageTexturePs() : data(NULL), width(0), height(0), bytesPerScanline(0), P0(vec4()), P1(vec4()) {}
+        // The decoded file is shared with every other texture that uses it (see TextureCache)
+        ImageTexturePs(const char* filename, const vec4& p0, const vec4& p1)
+            : image(TextureCache::load(filename)), P0(p0), P1(p1) {}
 
-        ImageTexturePs(const char* filename, vec4 p0, vec4 p1) : P0(p0), P1(p1) {
-            int componentsPerPixel = bytesPerPixel;
-
-            data = stbi_load(filename, &width, &height, &componentsPerPixel, componentsPerPixel);
-            if(!data) {
-                cerr << "Could not load texture file " << filename << endl;
-                height = 0;
-                width = 0;
-                return;
-            }
-            cout << filename << ": " << width << " " << height << endl;
-
-            bytesPerScanline = bytesPerPixel * width;
-        }
-
-        ~ImageTexturePs() {
-            delete data;
-        }
-
-        virtual color value(vec2 uv, const vec3& pc) const override {
+        virtual color value(vec2 uv, const vec3& pc, const Footprint& footprint) const override {
             //  s = P0.PC e r = P1.PC.
+            if(!image) return color(0, 0, 0);
 
             double u = abs(P0.dot(pc));
             double v = abs(P1.dot(pc));
 
-            int i = (int)(u * width);
-            int j = (int)(v * height);
-            
-            if(i >= width) i = width - 1;
-            if(j >= height) j = height - 1;
-
-            const double colorScale = 1.0 / 255.0;
-            auto pixel = data + j*bytesPerScanline + i*bytesPerPixel;
-
-            return color(colorScale * pixel[0], colorScale * pixel[1], colorScale * pixel[2]);
-            
-            return color(0, 0, 0);
+            // s and r change by |P0.xyz| and |P1.xyz| per world unit
+            double texels = footprint.width * max(vec3(P0[0], P0[1], P0[2]).length() * image->width(),
+                                                  vec3(P1[0], P1[1], P1[2]).length() * image->height());
+            return image->sample(u, v, texels, TextureCache::filter());
         }
 
 };
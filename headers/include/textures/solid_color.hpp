@@ -1,5 +1,5 @@
 #ifndef SOLID_COLOR_HPP
-#define TEXTURSSOLID_COLOR_HPPOLID_COLOR_HPPE_HPP
+#define SOLID_COLOR_HPP
 
 #include "texture.hpp"
 
@@ -13,10 +13,10 @@ class SolidColor : public Texture {
 
         SolidColor(double red, double green, double blue) : SolidColor(color(red, green, blue)) {}
 
-        virtual color value(vec2 uv, const p3& p) const override {
+        virtual color value(vec2 uv, const p3& p, const Footprint& footprint) const override {
             return col;
         }
 };
 typedef shared_ptr<SolidColor> SolidColorPtr;
 
-#endif // !TEXTURE_HPP
\ No newline at end of file
+#endif // !SOLID_COLOR_HPP
\ No newline at end of file
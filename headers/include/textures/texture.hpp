@@ -3,9 +3,17 @@
 
 #include "common.hpp"
 
+// Size of the ray cone where it hits a surface, used by filtered textures to pick a mip level.
+// width is the cone diameter in world units; uvPerUnit converts world lengths on the surface into
+// uv lengths (0 when the object does not provide it).
+struct Footprint {
+    real width = 0;
+    real uvPerUnit = 0;
+};
+
 class Texture {
     public:
-        virtual vec3 value(vec2 uv, const p3& p) const = 0;
+        virtual vec3 value(vec2 uv, const p3& p, const Footprint& footprint) const = 0;
 };
 typedef shared_ptr<Texture> TexturePtr;
 
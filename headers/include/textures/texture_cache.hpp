@@ -0,0 +1,97 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+
+#include "vec3.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class TextureFilter {
+    Nearest,   // closest texel of the full-resolution image
+    Trilinear  // bilinear in the two mip levels around the footprint, blended linearly
+};
+
+enum class TextureLayout {
+    Linear, // row-major texels
+    Tiled   // 4x4 texel tiles stored contiguously, tiles in row-major order
+};
+
+// Decoded RGB image, converted to float texels with its mip pyramid built at load time. Immutable
+// once loaded and shared by every texture that names its file.
+class TextureImage {
+    public:
+        static const int tileShift = 2; // Tiled: tiles of (1 << tileShift)^2 texels
+
+        // One level of the pyramid: RGB floats in [0, 1], first row at the top. In the Tiled layout the
+        // 4x4 neighbourhood of a texel (most bilinear lookups, and the nearby lookups of a spherical
+        // mapping) shares three cache lines, instead of spanning four scanlines far apart.
+        struct Level {
+            int width, height;
+            int tilesPerRow = 0; // 0 in the Linear layout
+            std::vector<float> texels;
+
+            size_t offset(int x, int y) const {
+                if(tilesPerRow == 0) return size_t(y) * width + x;
+                const int mask = (1 << tileShift) - 1;
+                size_t tile = size_t(y >> tileShift) * tilesPerRow + (x >> tileShift);
+                return (tile << (2 * tileShift)) + ((y & mask) << tileShift) + (x & mask);
+            }
+
+            const float* texel(int x, int y) const { return &texels[3 * offset(x, y)]; }
+        };
+
+        // data: 8-bit RGB as returned by stb_image; the pyramid is stored in the given layout
+        TextureImage(const unsigned char* data, int width, int height, TextureLayout layout);
+
+        int width() const { return levels[0].width; }
+        int height() const { return levels[0].height; }
+        int levelCount() const { return levels.size(); }
+        const Level& level(int i) const { return levels[i]; }
+
+        size_t bytes() const;
+
+        // Color at (u, v) in [0, 1] image coordinates (v = 0 on the top row). footprint is the width of
+        // the ray cone in full-resolution texels; it selects the mip levels for Trilinear.
+        color sample(double u, double v, double footprint, TextureFilter filter) const;
+
+    private:
+        std::vector<Level> levels;
+
+        static Level tiled(const Level& linear);
+        color bilinear(const Level& l, double u, double v) const;
+};
+typedef std::shared_ptr<const TextureImage> TextureImagePtr;
+
+// Process-wide cache of decoded texture images keyed by canonical path: each file is decoded once,
+// and every pigment that uses it shares the same handle. Entries live until clear(), so images stay
+// decoded across scenes rendered by the same process. Thread-safe.
+class TextureCache {
+    public:
+        // Returns the decoded image, decoding it on first use, or nullptr if the file cannot be read
+        static TextureImagePtr load(const std::string& path);
+
+        // Number of images and bytes of decoded pixels currently held by the cache
+        static size_t imageCount();
+        static size_t memoryUsage();
+
+        static void clear();
+
+        // Filter used by the image textures (Trilinear by default). Set before rendering.
+        static TextureFilter filter() { return currentFilter; }
+        static void setFilter(TextureFilter f) { currentFilter = f; }
+
+        // Texel layout of the images decoded from now on (Linear by default). Set before loading.
+        static TextureLayout layout() { return currentLayout; }
+        static void setLayout(TextureLayout l) { currentLayout = l; }
+
+    private:
+        static TextureFilter currentFilter;
+        static TextureLayout currentLayout;
+        static std::mutex mutex;
+        static std::unordered_map<std::string, TextureImagePtr> images;
+};
+
+#endif // !TEXTURE_CACHE_HPP
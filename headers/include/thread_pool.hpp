@@ -0,0 +1,62 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Conjunto fixo de threads com roubo de tarefas (work stealing).
+// Cada thread tem sua própria fila: consome tarefas do início dela e, quando fica sem trabalho,
+// rouba do fim da fila de outra thread. Assim blocos baratos (céu) e caros (vidro) se equilibram
+// entre os núcleos sem um ponto central de contenção.
+class ThreadPool {
+    public:
+        // threadCount <= 0 usa std::thread::hardware_concurrency()
+        explicit ThreadPool(int threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        int size() const { return workers.size(); }
+
+        // Executa todas as tarefas e retorna quando a última terminar.
+        // Pode ser chamada por várias threads ao mesmo tempo; os lotes dividem as mesmas threads.
+        void run(const std::vector<std::function<void()>>& tasks);
+
+    private:
+        // Tarefas de uma mesma chamada a run()
+        struct Batch {
+            int remaining;       // protegido por mutex
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        struct Task {
+            std::function<void()> fn;
+            Batch* batch;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable wake;
+        int pending = 0;         // tarefas enfileiradas e ainda não retiradas (protegido por sleepMutex)
+        bool stopping = false;
+
+        bool pop(int index, Task& task);
+        bool steal(int thief, Task& task);
+        void workerLoop(int index);
+};
+
+#endif // !THREAD_POOL_HPP
@@ -2,131 +2,99 @@
 #define VEC3_HPP
 
 #include <cmath>
+#include "real.hpp"
+#include "simd.hpp"
 #include <iostream>
 #include "common.hpp"
-#include "vec4.hpp"
 
 using namespace std;
 class vec4;
 
+// Vetor 3D guardado em 4 posições (a quarta é sempre 0), para que cada operação seja uma única
+// instrução vetorial sobre real4. Os componentes são calculados na mesma ordem da versão escalar,
+// então os resultados são idênticos bit a bit.
 class vec3 {
     public:
 
-        double p[3];
+        real4 v;
 
-        vec3() : vec3(0, 0, 0) {}
-        vec3(double c0, double c1, double c2) {
-            p[0] = c0;
-            p[1] = c1;
-            p[2] = c2;
-        }
+        vec3() : v(real4{0, 0, 0, 0}) {}
+        vec3(real c0, real c1, real c2) : v(real4{c0, c1, c2, 0}) {}
+        vec3(const real4& v) : v(v) {}
         vec3(string line) {
             vector<string> tokens = split(line);
-            p[0] = stod(tokens[0]);
-            p[1] = stod(tokens[1]);
-            p[2] = stod(tokens[2]);
+            v = real4{(real)stod(tokens[0]), (real)stod(tokens[1]), (real)stod(tokens[2]), 0};
         }
         
-        double x() const { return p[0]; }
-        double y() const { return p[1]; }
-        double z() const { return p[2]; }
+        real x() const { return v[0]; }
+        real y() const { return v[1]; }
+        real z() const { return v[2]; }
 
-        vec3 operator-() const { return vec3(-p[0], -p[1], -p[2]); }
-        double operator[] (int i) const { return p[i]; }
-        double& operator[] (int i) { return p[i]; }
+        vec3 operator-() const { return vec3(-v); }
+        real operator[] (int i) const { return v[i]; }
+        real& operator[] (int i) { return ((real*)&v)[i]; }
 
         vec3& operator+= (const vec3& u) {
-            p[0] += u.p[0];
-            p[1] += u.p[1];
-            p[2] += u.p[2];
+            v += u.v;
             return *this;
         }
 
-        vec3& operator+= (const double v) {
-            p[0] += v;
-            p[1] += v;
-            p[2] += v;
+        vec3& operator+= (const real t) {
+            v += real4{t, t, t, 0};
             return *this;
         }
 
-        vec3& operator*= (const double v) {
-            p[0] *= v;
-            p[1] *= v;
-            p[2] *= v;
+        vec3& operator*= (const real t) {
+            v *= t;
             return *this;
         }
 
-        vec3& operator/=(const double t) {
+        vec3& operator/=(const real t) {
             return *this *= 1/t;
         }
 
-        double length() const {
+        real length() const {
             return sqrt(lengthSquared());
         }
 
-        double lengthSquared() const {
-            return p[0]*p[0] + p[1]*p[1] + p[2]*p[2];
+        real lengthSquared() const {
+            return dot(*this);
         }
 
         inline ostream& print(ostream& os) const {
-            os << p[0] << " " << p[1] << " " << p[2];
+            os << v[0] << " " << v[1] << " " << v[2];
             return os;
         }
 
-        inline vec3 operator+(vec3 &v) {
-            return vec3(p[0] + v.p[0], p[1] + v.p[1], p[2] + v.p[2]);
-        }
-
-        inline vec3 operator-(vec3 &v) {
-            return vec3(p[0] - v.p[0], p[1] - v.p[1], p[2] - v.p[2]);
-        }
-
-        inline vec3 operator*(const vec3 &v) const {
-            return vec3(p[0] * v.p[0], p[1] * v.p[1], p[2] * v.p[2]);
-        }
-
-        inline vec3 operator/(vec3 &v) {
-            return vec3(p[0] / v.p[0], p[1] / v.p[1], p[2] / v.p[2]);
-        }
-
-        inline vec3 operator/(double t) {
-            return vec3(p[0] / t, p[1] / t, p[2] / t);
-        }
-
-        inline double dot(const vec3 &v) const {
-            const vec3 &u = *this;
-            return u.p[0] * v.p[0] + u.p[1] * v.p[1] + u.p[2] * v.p[2];
+        inline real dot(const vec3 &u) const {
+            real4 m = v * u.v;
+            return m[0] + m[1] + m[2];
         }
 
-        double dot(const vec4 &v) const;
+        real dot(const vec4 &u) const;
 
         inline static vec3 cross(const vec3 &u, const vec3 &v) {
-            return vec3(u.p[1] * v.p[2] - u.p[2] * v.p[1],
-                        u.p[2] * v.p[0] - u.p[0] * v.p[2],
-                        u.p[0] * v.p[1] - u.p[1] * v.p[0]);
-        }
-
-        inline vec3 normalize() {
-            return (*this) / length();
+            // (u.y v.z - u.z v.y, u.z v.x - u.x v.z, u.x v.y - u.y v.x) com permutações dos componentes
+            return vec3(yzx(u.v) * zxy(v.v) - zxy(u.v) * yzx(v.v));
         }
 
         inline vec3 normalize() const {
-            return vec3(p[0], p[1], p[2]) / length();
+            return vec3(v / length());
         }
 
-        inline vec3 sqrtv(){
-            return vec3(sqrt(p[0]), sqrt(p[1]), sqrt(p[2]));
+        inline vec3 sqrtv() const {
+            return vec3(sqrt(v[0]), sqrt(v[1]), sqrt(v[2]));
         }
 
-        bool sameDirection(const vec3 &v) {
-            return dot(v) > 0;
+        bool sameDirection(const vec3 &u) const {
+            return dot(u) > 0;
         }
 
         inline static vec3 random() {
             return vec3(randomDouble(), randomDouble(), randomDouble());
         }
 
-        inline static vec3 random(double min, double max) {
+        inline static vec3 random(real min, real max) {
             return vec3(randomDouble(min, max), randomDouble(min, max), randomDouble(min, max));
         }
 
@@ -157,30 +125,46 @@ class vec3 {
         }
 
         bool nearZero() const {
-            const auto limit = 1e-8;
-            return fabs(p[0]) < limit && fabs(p[1]) < limit && fabs(p[2]) < limit;
+            const auto limit = nearZeroEpsilon;
+            return fabs(v[0]) < limit && fabs(v[1]) < limit && fabs(v[2]) < limit;
         }
 
 
         vec3 reflect(const vec3& normal) const;
 
-        vec3 refract(const vec3& normal, double etaiOverEtat);
+        vec3 refract(const vec3& normal, real etaiOverEtat) const;
 
 };
 
-inline vec3 operator*(double t, const vec3 &v) {
-    return vec3(v[0] * t, v[1] * t, v[2] * t);
+inline vec3 operator*(real t, const vec3 &v) {
+    return vec3(v.v * t);
 }
 
 inline vec3 operator+(const vec3 &u, const vec3 &v) {
-    return vec3(u.p[0] + v.p[0], u.p[1] + v.p[1], u.p[2] + v.p[2]);
+    return vec3(u.v + v.v);
 }
 
 inline vec3 operator-(const vec3 &u, const vec3 &v) {
-    return vec3(u.p[0] - v.p[0], u.p[1] - v.p[1], u.p[2] - v.p[2]);
+    return vec3(u.v - v.v);
+}
+
+inline vec3 operator*(const vec3 &u, const vec3 &v) {
+    return vec3(u.v * v.v);
+}
+
+// o quarto componente do divisor vira 1 para não gerar 0/0 na posição de preenchimento
+inline vec3 operator/(const vec3 &u, const vec3 &v) {
+    return vec3(u.v / real4{v[0], v[1], v[2], 1});
+}
+
+inline vec3 operator/(const vec3 &u, real t) {
+    return vec3(u.v / t);
 }
 
 using p3 = vec3;
 using v3 = vec3;
 using color = vec3;
-#endif
\ No newline at end of file
+
+#include "vec4.hpp"
+
+#endif
@@ -2,38 +2,56 @@
 #define VEC4_HPP
 
 #include <cmath>
+#include "real.hpp"
 #include "vec3.hpp"
 
 using namespace std;
 
-class vec3;
-
 class vec4 {
     public:
-        double p[4];
-
-        vec4() : vec4(0, 0, 0, 0) {}
-        vec4(double c0, double c1, double c2, double c3) {
-            p[0] = c0;
-            p[1] = c1;
-            p[2] = c2;
-            p[3] = c3;
-        }
+        real4 v;
+
+        vec4() : v(real4{0, 0, 0, 0}) {}
+        vec4(real c0, real c1, real c2, real c3) : v(real4{c0, c1, c2, c3}) {}
+        vec4(const real4& v) : v(v) {}
 
-        vec4(vec3 v, double c3);
+        vec4(const vec3& u, real c3) : v(real4{u[0], u[1], u[2], c3}) {}
+
+        real operator[] (int i) const { return v[i]; }
+        real& operator[] (int i) { return ((real*)&v)[i]; }
+
+        vec4 normalize() const {
+            real len = length();
+            return len > 0 ? vec4(v / len) : *this;
+        }
 
-        double operator[] (int i) const { return p[i]; }
-        double& operator[] (int i) { return p[i]; }
+        // o ponto 3D é tratado como (x, y, z, 1)
+        real dot(const vec3 &u) const {
+            real4 m = v * u.v;
+            return m[0] + m[1] + m[2] + v[3] * 1.0;
+        }
 
-        vec4 normalize();
+        real dot(const vec4 &u) const {
+            real4 m = v * u.v;
+            return m[0] + m[1] + m[2] + m[3];
+        }
 
-        double dot(const vec3 &v) const;
-        double dot(const vec4 &v) const;
+        vec4 operator*(real t) const {
+            return vec4(v * t);
+        }
 
-        vec4 operator*(double t) const;
+        real lengthSquared() const {
+            return dot(*this);
+        }
 
-        double lengthSquared() const;
-        double length() const;
+        real length() const {
+            return sqrt(lengthSquared());
+        }
 };
 
-#endif
\ No newline at end of file
+inline real vec3::dot(const vec4 &u) const {
+    real4 m = v * u.v;
+    return m[0] + m[1] + m[2] + u.v[3] * 1.0;
+}
+
+#endif
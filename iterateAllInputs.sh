@@ -14,11 +14,20 @@ mkdir exec_out images_out
 
 make -j12
 
+# Manifesto com todas as cenas, renderizadas por um único processo (modo --batch)
+rm -f ./exec_out/manifest.txt
 for inputfile in ./inputs/*.*; do
     nameFile="${inputfile#./inputs/}"      # Remove a parte './inputs/' do caminho
     outputfile="${nameFile%.*}"             # Remove a extensão do nome do arquivo
 
-    # Chama o programa com o nome do arquivo de saída sem a extensão
-    ./demo "$inputfile" "./exec_out/$outputfile"
+    # Arquivo de saída sem a extensão
+    echo "$inputfile ./exec_out/$outputfile" >> ./exec_out/manifest.txt
+done
+
+./demo --batch ./exec_out/manifest.txt
+
+for inputfile in ./inputs/*.*; do
+    nameFile="${inputfile#./inputs/}"
+    outputfile="${nameFile%.*}"
     ffmpeg -i "./exec_out/$outputfile.ppm" "./images_out/${nameFile%.*}.png"
 done
@@ -1,60 +1,497 @@
 #include "input_processor.hpp"
 #include "renderer.hpp"
+#include "texture_cache.hpp"
+#include "text_reader.hpp"
+#include "camera_path.hpp"
+#include "frame_encoder.hpp"
+#include "scene_file.hpp"
+#include "distributed.hpp"
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <cstring>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
+#include <map>
+#include <set>
 
 using namespace std;
 
+// Parâmetros de renderização vindos da linha de comando, aplicados a cada cena carregada
+struct RenderSettings {
+    int imgWidth = 800;
+    int imgHeight = 600;
+    int samplesPerPixel = 15;
+    uint64_t seed = 0;
+    int threads = 0;
+    int maxDepth = 14;
+    int rouletteDepth = 3;
+    int packetSize = 8;
+    double noiseThreshold = 0;
+    int minSamples = 0;     // Limites da amostragem adaptativa; sem --min-spp/--max-spp são
+    int maxSamples = 0;     // deduzidos das amostras por pixel de cada cena (ver sampleLimits)
+    bool minSamplesGiven = false;
+    bool maxSamplesGiven = false;
+    string heatmapFile;
+    int passSamples = 0;
+    string checkpointFile;
+    double checkpointInterval = 0;
+    string resumeFile;
+    bool formatGiven = false;
+    ImageFormat format = ImageFormat::PPM_BINARY;
+};
+
+// Uma cena a renderizar: arquivo de entrada, de saída e resolução
+struct RenderJob {
+    string input;
+    string output;
+    int imgWidth, imgHeight, samplesPerPixel;
+};
+
+// Lê as opções comuns ao modo de uma cena e ao modo --batch. Retorna falso (com a mensagem em cerr)
+// se alguma for inválida.
+static bool parseSettings(map<string, string>& options, RenderSettings& settings) {
+    if(options.count("format")) {
+        if(!ImageWriter::parseFormat(options["format"], settings.format)) {
+            cerr << "Formato de saída desconhecido: " << options["format"] << endl;
+            return false;
+        }
+        settings.formatGiven = true;
+    }
+
+    if(options.count("seed")) {
+        settings.seed = strtoull(options["seed"].c_str(), nullptr, 10);
+    }
+
+    if(options.count("threads")) {
+        settings.threads = atoi(options["threads"].c_str());
+    }
+
+    if(options.count("max-depth")) {
+        settings.maxDepth = atoi(options["max-depth"].c_str());
+    }
+
+    if(options.count("roulette-depth")) {
+        settings.rouletteDepth = atoi(options["roulette-depth"].c_str());
+    }
+
+    if(options.count("packet")) {
+        settings.packetSize = atoi(options["packet"].c_str());
+        if(settings.packetSize < 0 || settings.packetSize > RayPacket::maxSize) {
+            cerr << "Tamanho de pacote inválido: " << settings.packetSize << " (use de 0 a " << RayPacket::maxSize << ")" << endl;
+            return false;
+        }
+    }
+
+    // Amostragem adaptativa: amostras_por_pixel passa a ser o máximo, a menos que --max-spp seja dado
+    if(options.count("adaptive")) {
+        settings.noiseThreshold = atof(options["adaptive"].c_str());
+        if(settings.noiseThreshold <= 0) {
+            cerr << "Limiar de ruído inválido: " << options["adaptive"] << endl;
+            return false;
+        }
+    }
+    if(options.count("max-spp")) {
+        settings.maxSamples = atoi(options["max-spp"].c_str());
+        settings.maxSamplesGiven = true;
+    }
+    if(options.count("min-spp")) {
+        settings.minSamples = atoi(options["min-spp"].c_str());
+        settings.minSamplesGiven = true;
+    }
+
+    if(options.count("texture-filter")) {
+        if(options["texture-filter"] == "nearest") {
+            TextureCache::setFilter(TextureFilter::Nearest);
+        } else if(options["texture-filter"] != "trilinear") {
+            cerr << "Filtro de textura desconhecido: " << options["texture-filter"] << endl;
+            return false;
+        }
+    }
+
+    if(options.count("texture-layout")) {
+        if(options["texture-layout"] == "tiled") {
+            TextureCache::setLayout(TextureLayout::Tiled);
+        } else if(options["texture-layout"] != "linear") {
+            cerr << "Layout de textura desconhecido: " << options["texture-layout"] << endl;
+            return false;
+        }
+    }
+
+    if(options.count("heatmap")) settings.heatmapFile = options["heatmap"];
+
+    // Renderização progressiva. Ao retomar sem --checkpoint, o mesmo arquivo continua sendo atualizado.
+    if(options.count("pass-spp")) settings.passSamples = atoi(options["pass-spp"].c_str());
+    if(options.count("resume")) settings.resumeFile = settings.checkpointFile = options["resume"];
+    if(options.count("checkpoint")) settings.checkpointFile = options["checkpoint"];
+    if(options.count("checkpoint-every")) settings.checkpointInterval = atof(options["checkpoint-every"].c_str());
+    return true;
+}
+
+// Formato de saída: escolhido com --format ou deduzido da extensão .pfm (padrão: PPM binário).
+// Adiciona a extensão do formato ao nome se não estiver presente.
+static ImageFormat outputFormat(const RenderSettings& settings, string& outputFileName) {
+    ImageFormat format = settings.format;
+    if(!settings.formatGiven && outputFileName.size() >= 4 && outputFileName.substr(outputFileName.size() - 4) == ".pfm") {
+        format = ImageFormat::PFM;
+    }
+
+    string extension = ImageWriter::extension(format);
+    if(outputFileName.size() < 4 || outputFileName.substr(outputFileName.size() - 4) != extension) {
+        outputFileName += extension;
+    }
+    return format;
+}
+
+// Limites de amostras da amostragem adaptativa para uma cena com samplesPerPixel amostras
+static bool sampleLimits(const RenderSettings& settings, int samplesPerPixel, int& minSamples, int& maxSamples) {
+    maxSamples = settings.maxSamplesGiven ? settings.maxSamples : samplesPerPixel;
+    minSamples = settings.minSamplesGiven ? settings.minSamples : min(4, maxSamples);
+    if(settings.noiseThreshold > 0 && (minSamples < 1 || maxSamples < minSamples)) {
+        cerr << "Limites de amostras inválidos: --min-spp " << minSamples << " --max-spp " << maxSamples << endl;
+        return false;
+    }
+    return true;
+}
+
+// Aplica os parâmetros de renderização à cena carregada
+static void applySettings(const RenderSettings& settings, const RenderJob& job, ImageFormat format,
+                          SceneDescription& scene) {
+    scene.imgWidth = job.imgWidth;
+    scene.imgHeight = job.imgHeight;
+    scene.aspectRatio = double(job.imgWidth) / double(job.imgHeight);
+    scene.samplesPerPixel = job.samplesPerPixel;
+    scene.seed = settings.seed;
+    scene.threads = settings.threads;
+    scene.maxDepth = settings.maxDepth;
+    scene.rouletteDepth = settings.rouletteDepth;
+    scene.packetSize = settings.packetSize;
+    scene.noiseThreshold = settings.noiseThreshold;
+    sampleLimits(settings, job.samplesPerPixel, scene.minSamples, scene.maxSamples);
+    scene.heatmapFile = settings.heatmapFile;
+    scene.passSamples = settings.passSamples;
+    scene.resumeFile = settings.resumeFile;
+    scene.checkpointFile = settings.checkpointFile;
+    scene.checkpointInterval = settings.checkpointInterval;
+    scene.outputFormat = format;
+}
+
+static void printTextureUsage() {
+    if(TextureCache::imageCount() > 0) {
+        cerr << "Texturas: " << TextureCache::imageCount() << " imagens, "
+             << TextureCache::memoryUsage() / 1024 << " KiB\n";
+    }
+}
+
+// Lê o manifesto do modo --batch: uma cena por linha, "entrada saída [largura altura amostras]".
+// Linhas vazias e linhas começando com # são ignoradas; a resolução omitida é a da linha de comando.
+static bool readManifest(const string& path, const RenderSettings& settings, vector<RenderJob>& jobs) {
+    MappedFile file;
+    if(!file.open(path)) {
+        cerr << "Erro: Não foi possível abrir o manifesto " << path << endl;
+        return false;
+    }
+
+    TextReader reader(file.contents());
+    try {
+        while(reader.nextLine()) {
+            if(!reader.hasMore()) continue;
+            RenderJob job;
+            job.input = string(reader.word());
+            if(job.input[0] == '#') continue;
+            job.output = string(reader.word());
+            if(job.output.empty()) {
+                throw runtime_error("linha " + to_string(reader.lineNumber()) + ": arquivo de saída esperado");
+            }
+            job.imgWidth = settings.imgWidth;
+            job.imgHeight = settings.imgHeight;
+            job.samplesPerPixel = settings.samplesPerPixel;
+            if(reader.hasMore()) {
+                job.imgWidth = reader.integer();
+                job.imgHeight = reader.integer();
+                if(reader.hasMore()) job.samplesPerPixel = reader.integer();
+            }
+            jobs.push_back(job);
+        }
+    } catch(const runtime_error& e) {
+        cerr << "Erro em " << path << ", " << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+// Modo --batch: renderiza todas as cenas do manifesto num único processo. O pool de threads e o cache
+// de texturas são compartilhados entre as cenas, e até jobs cenas são renderizadas ao mesmo tempo,
+// cada uma numa thread própria que entrega seus blocos ao pool comum: os blocos das cenas pequenas se
+// misturam e ocupam todos os núcleos. Retorna o número de cenas que falharam.
+static int renderBatch(const vector<RenderJob>& jobs, const RenderSettings& settings, int concurrentJobs) {
+    ThreadPool pool(settings.threads);
+    atomic<int> nextJob(0), failed(0);
+    mutex outputMutex;
+    auto start = chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        for(int i = nextJob++; i < (int)jobs.size(); i = nextJob++) {
+            RenderJob job = jobs[i];
+            ImageFormat format = outputFormat(settings, job.output);
+            auto jobStart = chrono::steady_clock::now();
+
+            SceneDescription scene;
+            bool ok = InputProcessor::processFile(job.input, scene);
+            if(ok) {
+                applySettings(settings, job, format, scene);
+                scene.showProgress = concurrentJobs == 1;
+                ok = Renderer::render(scene, job.output, pool);
+            }
+
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - jobStart).count();
+            lock_guard<mutex> lock(outputMutex);
+            if(!ok) failed++;
+            cerr << "[" << i + 1 << "/" << jobs.size() << "] " << job.input << " -> " << job.output << " ("
+                 << job.imgWidth << "x" << job.imgHeight << ", " << job.samplesPerPixel << " amostras, "
+                 << seconds << " s)" << (ok ? "" : " FALHOU") << endl;
+        }
+    };
+
+    vector<thread> workers;
+    for(int j = 1; j < concurrentJobs; j++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for(thread& t : workers) {
+        t.join();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << jobs.size() - failed << " de " << jobs.size() << " cenas renderizadas em " << seconds << " s ("
+         << pool.size() << " threads, " << concurrentJobs << " cenas por vez)" << endl;
+    printTextureUsage();
+    return failed;
+}
+
+// Modo --animation: renderiza a cena uma vez por quadro, trocando só a câmera, que segue os quadros-chave
+// de keyframes. Cena, texturas, BVH e pool de threads são os mesmos em todos os quadros, e cada quadro
+// pronto é gravado por FrameEncoder numa thread própria enquanto o seguinte é renderizado.
+static bool renderAnimation(SceneDescription& scene, const string& keyframes, const string& output,
+                            ImageFormat format, int fps) {
+    CameraPath path;
+    if(!path.load(keyframes, SceneFile::camera(scene))) {
+        return false;
+    }
+
+    FrameEncoder encoder;
+    if(!encoder.open(output, format, scene.imgWidth, scene.imgHeight, fps)) {
+        return false;
+    }
+
+    ThreadPool pool(scene.threads);
+    int frames = path.lastFrame() - path.firstFrame() + 1;
+    auto start = chrono::steady_clock::now();
+    for(int frame = path.firstFrame(); frame <= path.lastFrame(); frame++) {
+        SceneFile::applyCamera(path.at(frame), scene);
+        cerr << "Quadro " << frame << " (" << frame - path.firstFrame() + 1 << "/" << frames << ")\n";
+
+        unique_ptr<Framebuffer> fb = encoder.acquire();
+        Renderer::renderFrame(scene, *fb, pool);
+        encoder.submit(frame, move(fb));
+    }
+    bool written = encoder.finish();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << frames << " quadros em " << seconds << " s (" << frames / seconds << " quadros/s)" << endl;
+    if(written) {
+        cerr << "Animação salva em: " << (output.size() >= 4 && output.substr(output.size() - 4) == ".y4m"
+                                          ? output : encoder.framePath(path.firstFrame()) + " ...") << endl;
+    }
+    return written;
+}
+
+// Opções aceitas na linha de comando, todas no formato --nome valor
+static const set<string> knownOptions = {
+    "seed", "threads", "format", "max-depth", "roulette-depth", "packet", "adaptive", "min-spp", "max-spp",
+    "heatmap", "pass-spp", "checkpoint", "checkpoint-every", "resume", "texture-filter", "texture-layout",
+    "batch", "jobs", "animation", "fps", "distribute", "workers", "unit-rows", "worker"
+};
+
 int main(int argc, char** argv) {
+    // Separa opções no formato --nome valor dos argumentos posicionais. Uma opção desconhecida ou sem
+    // valor é um erro: ignorá-la renderizaria com os valores padrão, ou em outro modo, sem aviso.
+    vector<string> args;
+    map<string, string> options;
+    for(int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if(arg.size() > 2 && arg.substr(0, 2) == "--") {
+            if(knownOptions.count(arg.substr(2)) == 0) {
+                cerr << "Opção desconhecida: " << arg << endl;
+                return -1;
+            }
+            if(i + 1 >= argc) {
+                cerr << "Valor esperado para " << arg << endl;
+                return -1;
+            }
+            options[arg.substr(2)] = argv[++i];
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    bool batch = options.count("batch") > 0;
+    bool worker = options.count("worker") > 0;
+
     // Valida argumentos mínimos da linha de comando
-    if(argc < 3) {
+    if(args.size() < (batch ? 0u : worker ? 1u : 2u)) {
         cerr << "Uso: " << argv[0] << " <arquivo_entrada> <arquivo_saida>" << endl;
+        cerr << "     " << argv[0] << " --batch <manifesto> [--jobs <n>]" << endl;
+        cerr << "     " << argv[0] << " <arquivo_entrada> <prefixo_saida|saida.y4m> --animation <quadros_chave> [--fps <n>]" << endl;
+        cerr << "     " << argv[0] << " <arquivo_entrada> <arquivo_saida> --distribute <diretório> [--workers <n>] [--unit-rows <n>]" << endl;
+        cerr << "     " << argv[0] << " <arquivo_entrada> --worker <diretório>" << endl;
         cerr << "Parâmetros opcionais: <largura> <altura> <amostras_por_pixel>" << endl;
+        cerr << "Opções: --seed <n> --threads <n> --format <p3|p6|ppm16|pfm>" << endl;
+        cerr << "        --max-depth <n> --roulette-depth <n> --packet <n>" << endl;
+        cerr << "        --adaptive <limiar> --min-spp <n> --max-spp <n> --heatmap <arquivo.ppm>" << endl;
+        cerr << "        --texture-filter <trilinear|nearest> --texture-layout <linear|tiled>" << endl;
+        cerr << "        --pass-spp <n> --checkpoint <arquivo> --checkpoint-every <segundos> --resume <arquivo>" << endl;
+        return -1;
+    }
+
+    RenderSettings settings;
+    if(!parseSettings(options, settings)) {
         return -1;
     }
-    
+
+    // Processa parâmetros opcionais (no modo --batch, a resolução padrão das cenas do manifesto; no
+    // modo --worker não há arquivo de saída)
+    size_t sizeArg = batch ? 0 : worker ? 1 : 2;
+    if(args.size() >= sizeArg + 2) {
+        settings.imgWidth = atoi(args[sizeArg].c_str());
+        settings.imgHeight = atoi(args[sizeArg + 1].c_str());
+    }
+
+    if(args.size() >= sizeArg + 3) {
+        settings.samplesPerPixel = atoi(args[sizeArg + 2].c_str());
+    }
+
+    if(batch) {
+        // Arquivos por cena não fazem sentido para várias cenas
+        if(!settings.heatmapFile.empty() || !settings.checkpointFile.empty() || options.count("animation") ||
+           options.count("distribute") || worker) {
+            cerr << "As opções --heatmap, --checkpoint, --resume, --animation, --distribute e --worker não podem ser usadas com --batch" << endl;
+            return -1;
+        }
+        int concurrentJobs = options.count("jobs") ? atoi(options["jobs"].c_str()) : 1;
+        if(concurrentJobs < 1) {
+            cerr << "Número de cenas simultâneas inválido: " << options["jobs"] << endl;
+            return -1;
+        }
+
+        vector<RenderJob> jobs;
+        if(!readManifest(options["batch"], settings, jobs)) {
+            return -1;
+        }
+        int minSamples, maxSamples;
+        for(const RenderJob& job : jobs) {
+            if(!sampleLimits(settings, job.samplesPerPixel, minSamples, maxSamples)) return -1;
+        }
+        return renderBatch(jobs, settings, concurrentJobs) == 0 ? 0 : -1;
+    }
+
+    // Renderização distribuída: o coordenador (--distribute) e os workers (--worker) dividem a imagem
+    bool distribute = options.count("distribute") > 0;
+    if(distribute || worker) {
+        if(settings.passSamples > 0 || !settings.checkpointFile.empty() || options.count("animation") ||
+           (distribute && worker)) {
+            cerr << "As opções --pass-spp, --checkpoint, --resume e --animation não podem ser usadas com --distribute ou --worker" << endl;
+            return -1;
+        }
+    }
+    int workerCount = options.count("workers") ? atoi(options["workers"].c_str()) : 0;
+    int unitRows = options.count("unit-rows") ? atoi(options["unit-rows"].c_str()) : 32;
+    if(workerCount < 0 || unitRows < 1) {
+        cerr << "Número de workers ou de linhas por unidade inválido" << endl;
+        return -1;
+    }
+
     // Processa argumentos (variáveis locais ao invés de globais)
-    string inputFileName = argv[1];
-    string outputFileName = argv[2];
-    
-    // Adiciona extensão .ppm se não estiver presente
-    if(outputFileName.size() < 4 || outputFileName.substr(outputFileName.size() - 4) != ".ppm") {
-        outputFileName += ".ppm";
-    }
-    
-    // Parâmetros de renderização (valores padrão)
-    int imgWidth = 800;
-    int imgHeight = 600;
-    int samplesPerPixel = 15;
-    
-    // Processa parâmetros opcionais
-    if(argc >= 5) {
-        imgWidth = atoi(argv[3]);
-        imgHeight = atoi(argv[4]);
+    RenderJob job = {args[0], worker ? "" : args[1], settings.imgWidth, settings.imgHeight, settings.samplesPerPixel};
+    string outputPrefix = job.output;
+    ImageFormat format = outputFormat(settings, job.output);
+
+    // Animação: a saída é um prefixo para as imagens dos quadros ou um vídeo .y4m
+    bool animation = options.count("animation") > 0;
+    int fps = options.count("fps") ? atoi(options["fps"].c_str()) : 24;
+    if(animation) {
+        if(!settings.heatmapFile.empty() || !settings.checkpointFile.empty() || settings.passSamples > 0) {
+            cerr << "As opções --heatmap, --checkpoint, --resume e --pass-spp não podem ser usadas com --animation" << endl;
+            return -1;
+        }
+        if(fps < 1) {
+            cerr << "Quadros por segundo inválidos: " << options["fps"] << endl;
+            return -1;
+        }
     }
-    
-    if(argc >= 6) {
-        samplesPerPixel = atoi(argv[5]);
+
+    int minSamples, maxSamples;
+    if(!sampleLimits(settings, job.samplesPerPixel, minSamples, maxSamples)) {
+        return -1;
     }
-    
+
     // Processa arquivo de entrada e carrega a descrição da cena
     cerr << "Processando arquivo de entrada...\n";
-    SceneDescription scene = InputProcessor::processFile(inputFileName);
-    
+    SceneDescription scene;
+    if(!InputProcessor::processFile(job.input, scene)) {
+        return -1;
+    }
+    printTextureUsage();
+
     // Aplica parâmetros customizados de renderização
-    scene.imgWidth = imgWidth;
-    scene.imgHeight = imgHeight;
-    scene.aspectRatio = double(imgWidth) / double(imgHeight);
-    scene.samplesPerPixel = samplesPerPixel;
-    
+    applySettings(settings, job, format, scene);
+
+    if(animation) {
+        scene.showProgress = false;
+        return renderAnimation(scene, options["animation"], outputPrefix, format, fps) ? 0 : -1;
+    }
+
+    if(worker) {
+        scene.showProgress = false;
+        return DistributedRender::work(scene, options["worker"]) ? 0 : -1;
+    }
+
+    if(distribute) {
+        // Os workers locais recebem a mesma cena, resolução e opções, menos as do coordenador
+        vector<string> command = {argv[0], job.input, to_string(job.imgWidth), to_string(job.imgHeight),
+                                  to_string(job.samplesPerPixel)};
+        for(const auto& option : options) {
+            if(option.first == "distribute" || option.first == "workers" || option.first == "unit-rows" ||
+               option.first == "heatmap" || option.first == "format") continue;
+            command.push_back("--" + option.first);
+            command.push_back(option.second);
+        }
+
+        cerr << "Distribuindo a renderização em " << options["distribute"] << " (" << workerCount << " workers locais)\n";
+        scene.showProgress = false;
+        if(!DistributedRender::coordinate(scene, job.output, options["distribute"], command, workerCount, unitRows)) {
+            return -1;
+        }
+        cerr << "Imagem salva em: " << job.output << endl;
+        return 0;
+    }
+
     // Renderiza a cena e salva no arquivo de saída
     cerr << "Iniciando renderização...\n";
-    cerr << "Resolução: " << imgWidth << "x" << imgHeight << endl;
-    cerr << "Amostras por pixel: " << samplesPerPixel << endl;
-    Renderer::render(scene, outputFileName);
-    
-    cerr << "Imagem salva em: " << outputFileName << endl;
-    
+    cerr << "Resolução: " << job.imgWidth << "x" << job.imgHeight << endl;
+    if(settings.noiseThreshold > 0) {
+        cerr << "Amostras por pixel: " << minSamples << " a " << maxSamples << " (limiar de ruído " << settings.noiseThreshold << ")" << endl;
+    } else {
+        cerr << "Amostras por pixel: " << job.samplesPerPixel << endl;
+    }
+    if(!Renderer::render(scene, job.output)) {
+        return -1;
+    }
+
+    cerr << "Imagem salva em: " << job.output << endl;
+
     return 0;
 }
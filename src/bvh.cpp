@@ -0,0 +1,373 @@
+#include "bvh.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+
+void BVH::build(const vector<shared_ptr<Hittable>>& objects) {
+    clear();
+    if(objects.empty()) return;
+
+    // Calcula caixas e centróides uma única vez
+    vector<AABB> boxes(objects.size());
+    vector<p3> centroids(objects.size());
+    vector<int> indices(objects.size());
+    for(size_t i = 0; i < objects.size(); i++) {
+        objects[i]->boundingBox(boxes[i]);
+        centroids[i] = boxes[i].centroid();
+        indices[i] = i;
+    }
+
+    nodes.reserve(2 * objects.size());
+    nodes.push_back(BVHNode());
+    buildNode(0, 0, indices, 0, objects.size(), boxes, centroids);
+
+    // Ordena os primitivos na ordem das folhas para que cada folha seja um intervalo contíguo
+    primitives.resize(objects.size());
+    for(size_t i = 0; i < indices.size(); i++) {
+        primitives[i] = objects[indices[i]].get();
+    }
+
+    finishLeaves();
+}
+
+// Em cada folha, move as esferas para o início e guarda uma cópia compacta delas para o kernel SIMD
+void BVH::finishLeaves() {
+    for(BVHNode& node : nodes) {
+        if(!node.isLeaf()) continue;
+        auto begin = primitives.begin() + node.leftFirst;
+        auto middle = stable_partition(begin, begin + node.count, [](const Hittable* h) {
+            return dynamic_cast<const Sphere*>(h) != nullptr;
+        });
+        node.sphereCount = middle - begin;
+    }
+    for(const Hittable* h : primitives) {
+        spheres.add(dynamic_cast<const Sphere*>(h));
+    }
+}
+
+void BVH::bake(const vector<shared_ptr<Hittable>>& objects, vector<BVHBakedNode>& bakedNodes,
+               vector<uint32_t>& order) const {
+    bakedNodes.clear();
+    order.clear();
+    for(const BVHNode& node : nodes) {
+        bakedNodes.push_back(BVHBakedNode{node.leftFirst, node.count});
+    }
+
+    unordered_map<const Hittable*, uint32_t> index;
+    for(size_t i = 0; i < objects.size(); i++) {
+        index[objects[i].get()] = i;
+    }
+    for(const Hittable* h : primitives) {
+        order.push_back(index.at(h));
+    }
+}
+
+bool BVH::adopt(const vector<shared_ptr<Hittable>>& objects, const vector<AABB>& boxes,
+                const BVHBakedNode* bakedNodes, size_t nodeCount, const uint32_t* order, size_t orderCount) {
+    clear();
+    if(objects.empty()) return nodeCount == 0 && orderCount == 0;
+    if(nodeCount == 0 || nodeCount > 2 * objects.size() || orderCount != objects.size()) return false;
+
+    // A ordem precisa ser uma permutação dos objetos
+    vector<bool> used(objects.size(), false);
+    for(size_t i = 0; i < orderCount; i++) {
+        if(order[i] >= objects.size() || used[order[i]]) return false;
+        used[order[i]] = true;
+    }
+
+    // Filhos sempre depois do pai (o que exclui ciclos), profundidade limitada pela pilha do percurso
+    // e folhas cobrindo cada primitivo exatamente uma vez
+    vector<int> depth(nodeCount, -1);
+    depth[0] = 0;
+    fill(used.begin(), used.end(), false);
+    for(size_t i = 0; i < nodeCount; i++) {
+        const BVHBakedNode& node = bakedNodes[i];
+        if(depth[i] < 0 || depth[i] > maxTreeDepth) return false;
+        if(node.count > 0) {
+            if(node.leftFirst < 0 || (size_t)node.leftFirst + node.count > orderCount) return false;
+            for(int k = node.leftFirst; k < node.leftFirst + node.count; k++) {
+                if(used[k]) return false;
+                used[k] = true;
+            }
+        } else {
+            if(node.count < 0 || node.leftFirst <= (int64_t)i || (size_t)node.leftFirst + 1 >= nodeCount) return false;
+            if(depth[node.leftFirst] >= 0 || depth[node.leftFirst + 1] >= 0) return false;
+            depth[node.leftFirst] = depth[node.leftFirst + 1] = depth[i] + 1;
+        }
+    }
+    if(find(used.begin(), used.end(), false) != used.end()) return false;
+
+    primitives.resize(orderCount);
+    for(size_t i = 0; i < orderCount; i++) {
+        primitives[i] = objects[order[i]].get();
+    }
+
+    // Caixas de baixo para cima: os filhos sempre têm índice maior que o pai
+    nodes.resize(nodeCount);
+    for(size_t i = nodeCount; i-- > 0;) {
+        BVHNode& node = nodes[i];
+        node.leftFirst = bakedNodes[i].leftFirst;
+        node.count = bakedNodes[i].count;
+        node.box = AABB();
+        if(node.isLeaf()) {
+            for(int k = node.leftFirst; k < node.leftFirst + node.count; k++) {
+                node.box.expand(boxes[order[k]]);
+            }
+        } else {
+            node.box.expand(nodes[node.leftFirst].box);
+            node.box.expand(nodes[node.leftFirst + 1].box);
+        }
+    }
+
+    finishLeaves();
+    return true;
+}
+
+void BVH::buildNode(int nodeIndex, int depth, vector<int>& indices, int first, int count,
+                    const vector<AABB>& boxes, const vector<p3>& centroids) {
+    AABB box, centroidBox;
+    for(int i = first; i < first + count; i++) {
+        box.expand(boxes[indices[i]]);
+        centroidBox.expand(centroids[indices[i]]);
+    }
+    nodes[nodeIndex].box = box;
+
+    // Avalia divisões candidatas em cada eixo agrupando os centróides em baldes
+    double leafCost = count;
+    double bestCost = infinity;
+    int bestAxis = -1;
+    int bestSplit = 0;
+
+    if(count > 1 && depth < maxTreeDepth) {
+        for(int axis = 0; axis < 3; axis++) {
+            double lo = centroidBox.minimum[axis];
+            double extent = centroidBox.maximum[axis] - lo;
+            if(extent <= 0) continue;
+
+            AABB binBoxes[sahBins];
+            int binCounts[sahBins] = {0};
+            for(int i = first; i < first + count; i++) {
+                int b = (int)(sahBins * (centroids[indices[i]][axis] - lo) / extent);
+                if(b >= sahBins) b = sahBins - 1;
+                binCounts[b]++;
+                binBoxes[b].expand(boxes[indices[i]]);
+            }
+
+            // Varre da direita para a esquerda acumulando área e contagem
+            double rightArea[sahBins];
+            int rightCount[sahBins];
+            AABB acc;
+            int accCount = 0;
+            for(int b = sahBins - 1; b > 0; b--) {
+                acc.expand(binBoxes[b]);
+                accCount += binCounts[b];
+                rightArea[b] = acc.surfaceArea();
+                rightCount[b] = accCount;
+            }
+
+            acc = AABB();
+            accCount = 0;
+            for(int b = 0; b < sahBins - 1; b++) {
+                acc.expand(binBoxes[b]);
+                accCount += binCounts[b];
+                if(accCount == 0 || rightCount[b + 1] == 0) continue;
+
+                double cost = 0.125 + (acc.surfaceArea() * accCount + rightArea[b + 1] * rightCount[b + 1])
+                              / box.surfaceArea();
+                if(cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+    }
+
+    // Cria folha quando dividir não compensa, quando todos os centróides coincidem ou quando
+    // a árvore atinge a profundidade máxima suportada pela pilha do percurso
+    if(bestAxis < 0 || (count <= maxLeafSize && bestCost >= leafCost)) {
+        nodes[nodeIndex].leftFirst = first;
+        nodes[nodeIndex].count = count;
+        return;
+    }
+
+    double lo = centroidBox.minimum[bestAxis];
+    double extent = centroidBox.maximum[bestAxis] - lo;
+    auto middle = partition(indices.begin() + first, indices.begin() + first + count, [&](int idx) {
+        int b = (int)(sahBins * (centroids[idx][bestAxis] - lo) / extent);
+        if(b >= sahBins) b = sahBins - 1;
+        return b < bestSplit;
+    });
+    int leftCount = middle - (indices.begin() + first);
+
+    // Os filhos são alocados lado a lado: o direito fica sempre em leftFirst + 1
+    int leftChild = nodes.size();
+    nodes.push_back(BVHNode());
+    nodes.push_back(BVHNode());
+    nodes[nodeIndex].leftFirst = leftChild;
+    nodes[nodeIndex].count = 0;
+
+    buildNode(leftChild, depth + 1, indices, first, leftCount, boxes, centroids);
+    buildNode(leftChild + 1, depth + 1, indices, first + leftCount, count - leftCount, boxes, centroids);
+}
+
+bool BVH::hit(const Ray& r, real tMin, real tMax, HitRecord& rec, bool reflected) const {
+    if(nodes.empty()) return false;
+
+    v3 invDir(1.0 / r.dir.x(), 1.0 / r.dir.y(), 1.0 / r.dir.z());
+    HitRecord tempRecord;
+    bool hitAnything = false;
+    real closest = tMax;
+    // A esfera mais próxima só preenche o registro no final, se ninguém mais perto aparecer
+    int closestSphere = -1;
+
+    // Percurso iterativo com pilha explícita; a construção limita a profundidade a maxTreeDepth
+    int stack[maxTreeDepth + 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if(!node.box.hit(r.orig, invDir, tMin, closest)) continue;
+
+        if(node.isLeaf()) {
+            if(node.sphereCount > 0) {
+                int s = spheres.closestHit(r, node.leftFirst, node.sphereCount, tMin, closest, reflected);
+                if(s >= 0) {
+                    hitAnything = true;
+                    closestSphere = s;
+                }
+            }
+            for(int i = node.leftFirst + node.sphereCount; i < node.leftFirst + node.count; i++) {
+                if(primitives[i]->hit(r, tMin, closest, tempRecord)) {
+                    if(reflected || !tempRecord.matPtr->ghostMaterial) {
+                        hitAnything = true;
+                        closest = tempRecord.t;
+                        closestSphere = -1;
+                        rec = tempRecord;
+                    }
+                }
+            }
+        } else {
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+        }
+    }
+
+    if(closestSphere >= 0) spheres.sphere(closestSphere)->fillRecord(r, closest, rec);
+    return hitAnything;
+}
+
+bool BVH::occluded(const Ray& r, real tMin, real tMax) const {
+    if(nodes.empty()) return false;
+
+    v3 invDir(1.0 / r.dir.x(), 1.0 / r.dir.y(), 1.0 / r.dir.z());
+    int stack[maxTreeDepth + 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if(!node.box.hit(r.orig, invDir, tMin, tMax)) continue;
+
+        if(node.isLeaf()) {
+            if(node.sphereCount > 0 && spheres.anyHit(r, node.leftFirst, node.sphereCount, tMin, tMax)) return true;
+            for(int i = node.leftFirst + node.sphereCount; i < node.leftFirst + node.count; i++) {
+                if(primitives[i]->occluded(r, tMin, tMax)) return true;
+            }
+        } else {
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+        }
+    }
+
+    return false;
+}
+
+// Teste de AABB::hit para os raios de laneMask, SimdDouble::width raios por instrução: bit i ligado
+// para cada raio i que atravessa a caixa em [tMin, closest[i]]
+static int boxMask(const AABB& box, const RayPacket& packet, int laneMask, real tMin, const double* closest) {
+    const int W = SimdDouble::width;
+    const double* origin[3] = {packet.ox, packet.oy, packet.oz};
+    const double* invDir[3] = {packet.invX, packet.invY, packet.invZ};
+    const SimdDouble zero(0.0);
+    int mask = 0;
+
+    for(int i = 0; i < packet.padded; i += W) {
+        SimdDouble lo(tMin);
+        SimdDouble hi = SimdDouble::load(&closest[i]);
+        for(int a = 0; a < 3; a++) {
+            SimdDouble o = SimdDouble::load(&origin[a][i]);
+            SimdDouble inv = SimdDouble::load(&invDir[a][i]);
+            SimdDouble t0 = (SimdDouble(box.minimum[a]) - o) * inv;
+            SimdDouble t1 = (SimdDouble(box.maximum[a]) - o) * inv;
+            SimdDouble negative = inv < zero;
+            SimdDouble tNear = SimdDouble::select(negative, t1, t0);
+            SimdDouble tFar = SimdDouble::select(negative, t0, t1);
+            lo = SimdDouble::select(tNear > lo, tNear, lo);
+            hi = SimdDouble::select(tFar < hi, tFar, hi);
+        }
+        mask |= (~(hi < lo).bits() & ((1 << W) - 1)) << i;
+    }
+
+    return mask & laneMask;
+}
+
+int BVH::hitPacket(const RayPacket& packet, real tMin, real* closest, HitRecord* recs, bool reflected) const {
+    if(nodes.empty()) return 0;
+
+    // Distâncias em double para os testes SIMD; as posições de enchimento nunca são aceitas
+    alignas(64) double closestLane[RayPacket::maxSize];
+    int closestSphere[RayPacket::maxSize];
+    for(int i = 0; i < packet.padded; i++) {
+        closestLane[i] = i < packet.size ? closest[i] : tMin;
+        closestSphere[i] = -1;
+    }
+
+    HitRecord tempRecord;
+    int valid = packet.validMask();
+    int hitMask = 0;
+
+    int stack[maxTreeDepth + 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while(stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        int active = boxMask(node.box, packet, valid, tMin, closestLane);
+        if(active == 0) continue;
+
+        if(node.isLeaf()) {
+            if(node.sphereCount > 0) {
+                hitMask |= spheres.closestHitPacket(packet, active, node.leftFirst, node.sphereCount, tMin,
+                                                    closestLane, closestSphere, reflected);
+            }
+            // Os demais primitivos são testados raio a raio, na mesma ordem de hit
+            for(int i = node.leftFirst + node.sphereCount; i < node.leftFirst + node.count; i++) {
+                for(int lane = 0; lane < packet.size; lane++) {
+                    if(!(active & (1 << lane))) continue;
+                    if(primitives[i]->hit(packet.rays[lane], tMin, closestLane[lane], tempRecord)) {
+                        if(reflected || !tempRecord.matPtr->ghostMaterial) {
+                            hitMask |= 1 << lane;
+                            closestLane[lane] = tempRecord.t;
+                            closestSphere[lane] = -1;
+                            recs[lane] = tempRecord;
+                        }
+                    }
+                }
+            }
+        } else {
+            stack[stackSize++] = node.leftFirst + 1;
+            stack[stackSize++] = node.leftFirst;
+        }
+    }
+
+    for(int lane = 0; lane < packet.size; lane++) {
+        closest[lane] = closestLane[lane];
+        if(closestSphere[lane] >= 0) {
+            spheres.sphere(closestSphere[lane])->fillRecord(packet.rays[lane], closest[lane], recs[lane]);
+        }
+    }
+    return hitMask;
+}
@@ -0,0 +1,101 @@
+#include "camera_path.hpp"
+#include "text_reader.hpp"
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+bool CameraPath::load(const string& path, const CameraRecord& base) {
+    keys.clear();
+
+    MappedFile file;
+    if(!file.open(path)) {
+        cerr << "Erro: Não foi possível abrir o arquivo " << path << endl;
+        return false;
+    }
+
+    TextReader reader(file.contents());
+    try {
+        while(reader.nextLine()) {
+            if(!reader.hasMore()) continue;
+            TextReader peek = reader;
+            if(peek.word()[0] == '#') continue;
+
+            Key key;
+            key.camera = base;
+            key.frame = reader.integer();
+            for(int k = 0; k < 3; k++) key.camera.lookFrom[k] = reader.number();
+            for(int k = 0; k < 3; k++) key.camera.lookAt[k] = reader.number();
+            for(int k = 0; k < 3; k++) key.camera.vUp[k] = reader.number();
+            key.camera.vFov = reader.number();
+            if(reader.hasMore()) {
+                key.camera.aperture = reader.number();
+                key.camera.distToFocus = reader.number();
+            }
+
+            if(!keys.empty() && key.frame <= keys.back().frame) {
+                throw runtime_error("linha " + to_string(reader.lineNumber()) + ": quadros-chave fora de ordem");
+            }
+            keys.push_back(key);
+        }
+    } catch(const runtime_error& e) {
+        cerr << "Erro em " << path << ", " << e.what() << endl;
+        keys.clear();
+        return false;
+    }
+
+    if(keys.empty()) {
+        cerr << "Erro: " << path << " não tem quadros-chave" << endl;
+        return false;
+    }
+    return true;
+}
+
+void CameraPath::tangent(size_t i, int which, double out[3]) const {
+    // Catmull-Rom: diferença entre os vizinhos; nas pontas, a diferença para o único vizinho
+    size_t prev = i > 0 ? i - 1 : i;
+    size_t next = i + 1 < keys.size() ? i + 1 : i;
+    const double* p0 = position(keys[prev].camera, which);
+    const double* p1 = position(keys[next].camera, which);
+    double frames = keys[next].frame - keys[prev].frame;
+    for(int k = 0; k < 3; k++) {
+        out[k] = frames > 0 ? (p1[k] - p0[k]) / frames : 0;
+    }
+}
+
+CameraRecord CameraPath::at(double frame) const {
+    if(frame <= keys.front().frame) return keys.front().camera;
+    if(frame >= keys.back().frame) return keys.back().camera;
+
+    // Segmento [i, i + 1] que contém o quadro
+    size_t i = 0;
+    while(keys[i + 1].frame < frame) i++;
+    const CameraRecord& a = keys[i].camera;
+    const CameraRecord& b = keys[i + 1].camera;
+    double length = keys[i + 1].frame - keys[i].frame;
+    double t = (frame - keys[i].frame) / length;
+
+    CameraRecord c = a;
+    auto lerp = [t](double x, double y) { return x + t * (y - x); };
+    for(int k = 0; k < 3; k++) c.vUp[k] = lerp(a.vUp[k], b.vUp[k]);
+    c.vFov = lerp(a.vFov, b.vFov);
+    c.aperture = lerp(a.aperture, b.aperture);
+    c.distToFocus = lerp(a.distToFocus, b.distToFocus);
+
+    // Bases de Hermite; as tangentes, por quadro, são escaladas pela duração do segmento
+    double t2 = t * t, t3 = t2 * t;
+    double h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + t;
+    double h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+    for(int which = 0; which < 2; which++) {
+        double m0[3], m1[3];
+        tangent(i, which, m0);
+        tangent(i + 1, which, m1);
+        const double* p0 = position(a, which);
+        const double* p1 = position(b, which);
+        double* out = which == 0 ? c.lookFrom : c.lookAt;
+        for(int k = 0; k < 3; k++) {
+            out[k] = h00 * p0[k] + h10 * length * m0[k] + h01 * p1[k] + h11 * length * m1[k];
+        }
+    }
+    return c;
+}
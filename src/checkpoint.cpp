@@ -0,0 +1,112 @@
+#include "checkpoint.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+namespace {
+    const char magic[8] = {'R', 'T', 'C', 'K', 'P', 'T', '\n', '\0'};
+    const uint32_t version = 2;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        int32_t width, height, stride;
+        int32_t maxDepth, rouletteDepth;
+        int32_t samplesDone;
+        int32_t minSamples;
+        uint64_t seed;
+        uint64_t sceneHash;
+        double noiseThreshold;
+    };
+
+    Header makeHeader(const SceneDescription& scene, const Framebuffer& fb, int samplesDone) {
+        Header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.width = fb.width();
+        h.height = fb.height();
+        h.stride = fb.stride();
+        h.maxDepth = scene.maxDepth;
+        h.rouletteDepth = scene.rouletteDepth;
+        h.samplesDone = samplesDone;
+        h.minSamples = scene.noiseThreshold > 0 ? scene.minSamples : 0;
+        h.seed = scene.seed;
+        h.sceneHash = scene.sceneHash;
+        h.noiseThreshold = scene.noiseThreshold;
+        return h;
+    }
+}
+
+bool Checkpoint::save(const string& path, const SceneDescription& scene, const Framebuffer& fb, int samplesDone) {
+    string temp = path + ".tmp";
+    {
+        ofstream file(temp, ios::out | ios::binary | ios::trunc);
+        if(!file.is_open()) {
+            cerr << "Erro: Não foi possível criar o arquivo " << temp << endl;
+            return false;
+        }
+
+        Header h = makeHeader(scene, fb, samplesDone);
+        size_t pixels = fb.pixelCount();
+        file.write((const char*)&h, sizeof(h));
+        file.write((const char*)fb.accumData(), pixels * 4 * sizeof(float));
+        file.write((const char*)fb.sampleData(), pixels * sizeof(uint32_t));
+        file.write((const char*)fb.meanData(), pixels * sizeof(float));
+        file.write((const char*)fb.m2Data(), pixels * sizeof(float));
+        if(!file) {
+            cerr << "Erro: Falha ao gravar o ponto de controle " << temp << endl;
+            return false;
+        }
+    }
+
+    error_code ec;
+    filesystem::rename(temp, path, ec);
+    if(ec) {
+        cerr << "Erro: Não foi possível substituir " << path << ": " << ec.message() << endl;
+        return false;
+    }
+    return true;
+}
+
+bool Checkpoint::load(const string& path, const SceneDescription& scene, Framebuffer& fb, int& samplesDone) {
+    ifstream file(path, ios::binary);
+    if(!file.is_open()) {
+        cerr << "Erro: Não foi possível abrir o ponto de controle " << path << endl;
+        return false;
+    }
+
+    Header h;
+    if(!file.read((char*)&h, sizeof(h)) || memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version) {
+        cerr << "Erro: " << path << " não é um ponto de controle desta versão do programa" << endl;
+        return false;
+    }
+
+    Header expected = makeHeader(scene, fb, h.samplesDone);
+    if(memcmp(&h, &expected, sizeof(h)) != 0) {
+        cerr << "Erro: O ponto de controle " << path << " foi gravado com outros parâmetros ("
+             << h.width << "x" << h.height << ", semente " << h.seed << ", profundidade " << h.maxDepth
+             << "/" << h.rouletteDepth << ", limiar de ruído " << h.noiseThreshold << ", mínimo de "
+             << h.minSamples << " amostras";
+        if(h.sceneHash != expected.sceneHash) cerr << ", outra cena";
+        cerr << ")" << endl;
+        return false;
+    }
+
+    size_t pixels = fb.pixelCount();
+    file.read((char*)fb.accumData(), pixels * 4 * sizeof(float));
+    file.read((char*)fb.sampleData(), pixels * sizeof(uint32_t));
+    file.read((char*)fb.meanData(), pixels * sizeof(float));
+    file.read((char*)fb.m2Data(), pixels * sizeof(float));
+    if(!file) {
+        cerr << "Erro: O ponto de controle " << path << " está incompleto" << endl;
+        fb.clear();
+        return false;
+    }
+
+    samplesDone = h.samplesDone;
+    return true;
+}
@@ -0,0 +1,372 @@
+#include "distributed.hpp"
+#include "renderer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+using namespace std;
+
+namespace {
+    const char jobMagic[8] = {'R', 'T', 'J', 'O', 'B', '\n', '\0', '\0'};
+    const char partMagic[8] = {'R', 'T', 'P', 'A', 'R', 'T', '\n', '\0'};
+    const uint32_t version = 2;
+    const chrono::milliseconds pollInterval(20);
+
+    // Descrição do trabalho: tudo o que muda as amostras precisa ser igual no coordenador e nos workers
+    struct JobHeader {
+        char magic[8];
+        uint32_t version;
+        int32_t width, height;
+        int32_t samplesPerPixel, minSamples, maxSamples;
+        int32_t maxDepth, rouletteDepth, packetSize;
+        int32_t unitRows, unitCount;
+        double noiseThreshold;
+        uint64_t seed;
+        uint64_t sceneHash;   // SceneDescription::sceneHash: workers precisam ter carregado a mesma cena
+        uint64_t id;
+    };
+
+    struct PartHeader {
+        char magic[8];
+        uint32_t version;
+        int32_t unit;
+        uint64_t id;
+    };
+
+    // Plano do framebuffer e tamanho de cada pixel nele, na ordem em que vão para as partes
+    struct Plane {
+        char* data;
+        size_t pixelBytes;
+    };
+
+    JobHeader makeJob(const SceneDescription& scene) {
+        JobHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, jobMagic, sizeof(jobMagic));
+        h.version = version;
+        h.width = scene.imgWidth;
+        h.height = scene.imgHeight;
+        h.samplesPerPixel = scene.samplesPerPixel;
+        h.minSamples = scene.minSamples;
+        h.maxSamples = scene.maxSamples;
+        h.maxDepth = scene.maxDepth;
+        h.rouletteDepth = scene.rouletteDepth;
+        h.packetSize = scene.packetSize;
+        h.noiseThreshold = scene.noiseThreshold;
+        h.seed = scene.seed;
+        h.sceneHash = scene.sceneHash;
+        return h;
+    }
+
+    bool sameParameters(const JobHeader& a, const JobHeader& b) {
+        return a.width == b.width && a.height == b.height && a.samplesPerPixel == b.samplesPerPixel &&
+               a.minSamples == b.minSamples && a.maxSamples == b.maxSamples && a.maxDepth == b.maxDepth &&
+               a.rouletteDepth == b.rouletteDepth && a.packetSize == b.packetSize &&
+               a.noiseThreshold == b.noiseThreshold && a.seed == b.seed;
+    }
+
+    vector<Plane> planes(Framebuffer& fb) {
+        return {{(char*)fb.accumData(), 4 * sizeof(float)}, {(char*)fb.sampleData(), sizeof(uint32_t)},
+                {(char*)fb.meanData(), sizeof(float)}, {(char*)fb.m2Data(), sizeof(float)}};
+    }
+
+    string jobPath(const string& dir) {
+        return dir + "/job";
+    }
+
+    string idPrefix(uint64_t id) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "%016llx.", (unsigned long long)id);
+        return prefix;
+    }
+
+    string unitPath(const string& dir, const JobHeader& job, int unit, const char* kind) {
+        char name[32];
+        snprintf(name, sizeof(name), "%04d.%s", unit, kind);
+        return dir + "/" + idPrefix(job.id) + name;
+    }
+
+    int unitRowTo(const JobHeader& job, int unit) {
+        return min((unit + 1) * job.unitRows, job.height) - 1;
+    }
+
+    string hostName() {
+        char name[256] = {0};
+        gethostname(name, sizeof(name) - 1);
+        return name;
+    }
+
+    bool readJob(const string& dir, JobHeader& h) {
+        ifstream file(jobPath(dir), ios::binary);
+        return file.read((char*)&h, sizeof(h)) && memcmp(h.magic, jobMagic, sizeof(jobMagic)) == 0 &&
+               h.version == version;
+    }
+
+    // Reivindica a unidade criando o arquivo de forma exclusiva; o conteúdo (máquina e pid) identifica o dono
+    bool claim(const string& dir, const JobHeader& job, int unit) {
+        string path = unitPath(dir, job, unit, "claim");
+        int fd = open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+        if(fd < 0) return false;
+        string owner = hostName() + " " + to_string(getpid()) + "\n";
+        bool written = ::write(fd, owner.data(), owner.size()) == (ssize_t)owner.size();
+        close(fd);
+        if(!written) unlink(path.c_str()); // sem dono conhecido, a unidade nunca seria recuperada
+        return written;
+    }
+
+    // Verdadeiro se a unidade foi reivindicada por um processo desta máquina que já terminou
+    bool abandoned(const string& dir, const JobHeader& job, int unit) {
+        ifstream file(unitPath(dir, job, unit, "claim"));
+        string host;
+        long pid;
+        if(!(file >> host >> pid)) return false;
+        return host == hostName() && kill(pid, 0) != 0 && errno == ESRCH;
+    }
+
+    // Grava as linhas da unidade num arquivo temporário e o renomeia para a parte definitiva
+    bool writePart(const string& dir, const JobHeader& job, int unit, Framebuffer& fb) {
+        string path = unitPath(dir, job, unit, "part");
+        string temp = path + ".tmp";
+        {
+            ofstream file(temp, ios::out | ios::binary | ios::trunc);
+            if(!file.is_open()) {
+                cerr << "Erro: Não foi possível criar o arquivo " << temp << endl;
+                return false;
+            }
+
+            PartHeader h;
+            memset(&h, 0, sizeof(h));
+            memcpy(h.magic, partMagic, sizeof(partMagic));
+            h.version = version;
+            h.unit = unit;
+            h.id = job.id;
+            file.write((const char*)&h, sizeof(h));
+            for(const Plane& p : planes(fb)) {
+                for(int row = unit * job.unitRows; row <= unitRowTo(job, unit); row++) {
+                    file.write(p.data + fb.index(row, 0) * p.pixelBytes, job.width * p.pixelBytes);
+                }
+            }
+            if(!file) {
+                cerr << "Erro: Falha ao gravar " << temp << endl;
+                return false;
+            }
+        }
+
+        error_code ec;
+        filesystem::rename(temp, path, ec);
+        if(ec) {
+            cerr << "Erro: Não foi possível renomear " << temp << ": " << ec.message() << endl;
+            return false;
+        }
+        return true;
+    }
+
+    enum class PartStatus { Missing, Merged, Invalid };
+
+    // Copia a parte da unidade para as linhas correspondentes de fb
+    PartStatus mergePart(const string& dir, const JobHeader& job, int unit, Framebuffer& fb) {
+        ifstream file(unitPath(dir, job, unit, "part"), ios::binary);
+        if(!file.is_open()) return PartStatus::Missing;
+
+        PartHeader h;
+        if(!file.read((char*)&h, sizeof(h)) || memcmp(h.magic, partMagic, sizeof(partMagic)) != 0 ||
+           h.version != version || h.id != job.id || h.unit != unit) {
+            return PartStatus::Invalid;
+        }
+        for(const Plane& p : planes(fb)) {
+            for(int row = unit * job.unitRows; row <= unitRowTo(job, unit); row++) {
+                if(!file.read(p.data + fb.index(row, 0) * p.pixelBytes, job.width * p.pixelBytes)) {
+                    return PartStatus::Invalid;
+                }
+            }
+        }
+        return PartStatus::Merged;
+    }
+
+    bool publishJob(const string& dir, const JobHeader& job) {
+        error_code ec;
+        filesystem::create_directories(dir, ec);
+        string temp = jobPath(dir) + ".tmp";
+        {
+            ofstream file(temp, ios::out | ios::binary | ios::trunc);
+            if(!file.is_open() || !file.write((const char*)&job, sizeof(job))) {
+                cerr << "Erro: Não foi possível criar o arquivo " << temp << endl;
+                return false;
+            }
+        }
+        filesystem::rename(temp, jobPath(dir), ec);
+        if(ec) {
+            cerr << "Erro: Não foi possível publicar o trabalho em " << dir << ": " << ec.message() << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Remove o trabalho e as reivindicações e partes dele
+    void removeJob(const string& dir, const JobHeader& job) {
+        error_code ec;
+        JobHeader current;
+        if(readJob(dir, current) && current.id == job.id) filesystem::remove(jobPath(dir), ec);
+
+        string prefix = idPrefix(job.id);
+        for(const auto& entry : filesystem::directory_iterator(dir, ec)) {
+            if(entry.path().filename().string().compare(0, prefix.size(), prefix) == 0) {
+                filesystem::remove(entry.path(), ec);
+            }
+        }
+    }
+}
+
+bool DistributedRender::coordinate(const SceneDescription& scene, const string& outputFile, const string& dir,
+                                   const vector<string>& workerCommand, int workerCount, int unitRows) {
+    JobHeader job = makeJob(scene);
+    job.unitRows = max((unitRows + Renderer::tileSize - 1) / Renderer::tileSize, 1) * Renderer::tileSize;
+    job.unitCount = (scene.imgHeight + job.unitRows - 1) / job.unitRows;
+    random_device entropy;
+    job.id = (uint64_t(entropy()) << 32) ^ entropy() ^ uint64_t(chrono::steady_clock::now().time_since_epoch().count());
+    if(!publishJob(dir, job)) return false;
+
+    // Workers locais: o próprio executável (/proc/self/exe), com a linha de comando dada e o diretório
+    vector<string> args = workerCommand;
+    args.push_back("--worker");
+    args.push_back(dir);
+    vector<char*> argv;
+    for(string& arg : args) argv.push_back(&arg[0]);
+    argv.push_back(nullptr);
+    vector<pid_t> children;
+    for(int i = 0; i < workerCount; i++) {
+        pid_t pid;
+        int err = posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr, argv.data(), environ);
+        if(err != 0) {
+            cerr << "Aviso: Não foi possível iniciar um worker: " << strerror(err) << endl;
+            continue;
+        }
+        children.push_back(pid);
+    }
+
+    Framebuffer fb(scene.imgWidth, scene.imgHeight, Renderer::tileSize);
+    ThreadPool pool(scene.threads);
+    vector<bool> done(job.unitCount, false);
+    int remaining = job.unitCount;
+    int nextClaim = 0;
+    int ownUnits = 0;
+    auto start = chrono::steady_clock::now();
+
+    auto renderUnit = [&](int unit) {
+        Renderer::renderRows(scene, fb, unit * job.unitRows, unitRowTo(job, unit), pool);
+        done[unit] = true;
+        remaining--;
+        ownUnits++;
+    };
+
+    // O coordenador renderiza uma unidade livre por vez e, entre elas, reúne as partes entregues
+    bool ok = true;
+    while(remaining > 0 && ok) {
+        bool progress = false;
+        while(nextClaim < job.unitCount && !progress) {
+            int unit = nextClaim++;
+            if(claim(dir, job, unit)) {
+                renderUnit(unit);
+                progress = true;
+            }
+        }
+
+        // Recolhe os workers que terminaram, antes de procurar unidades abandonadas por eles
+        for(size_t i = 0; i < children.size(); ) {
+            int status;
+            if(waitpid(children[i], &status, WNOHANG) == children[i]) {
+                if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    cerr << "\nAviso: o worker " << children[i] << " terminou com erro" << endl;
+                }
+                children.erase(children.begin() + i);
+            } else {
+                i++;
+            }
+        }
+
+        for(int unit = 0; unit < nextClaim && ok; unit++) {
+            if(done[unit]) continue;
+            PartStatus status = mergePart(dir, job, unit, fb);
+            if(status == PartStatus::Merged) {
+                done[unit] = true;
+                remaining--;
+                progress = true;
+            } else if(status == PartStatus::Invalid) {
+                cerr << "\nErro: parte inválida da unidade " << unit << " em " << dir << endl;
+                ok = false;
+            } else if(abandoned(dir, job, unit) || claim(dir, job, unit)) {
+                cerr << "\nAviso: unidade " << unit << " abandonada por um worker, renderizada pelo coordenador" << endl;
+                renderUnit(unit);
+                progress = true;
+            }
+        }
+
+        if(progress) cerr << "\rUnidades restantes: " << remaining << ' ' << flush;
+        else this_thread::sleep_for(pollInterval);
+    }
+
+    // Encerra o trabalho: sem o arquivo do trabalho, os workers param de reivindicar unidades
+    error_code ec;
+    filesystem::remove(jobPath(dir), ec);
+    for(pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+    removeJob(dir, job);
+    if(!ok) return false;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << "\n" << job.unitCount << " unidades de " << job.unitRows << " linhas em " << seconds << " s ("
+         << ownUnits << " no coordenador, " << job.unitCount - ownUnits << " nos workers)" << endl;
+    return Renderer::write(scene, fb, outputFile);
+}
+
+bool DistributedRender::work(const SceneDescription& scene, const string& dir) {
+    JobHeader job;
+    auto start = chrono::steady_clock::now();
+    while(!readJob(dir, job)) {
+        if(chrono::duration<double>(chrono::steady_clock::now() - start).count() > jobWaitSeconds) {
+            cerr << "Erro: nenhum trabalho publicado em " << dir << endl;
+            return false;
+        }
+        this_thread::sleep_for(pollInterval);
+    }
+    if(job.sceneHash != scene.sceneHash) {
+        cerr << "Erro: o trabalho em " << dir << " é de outra cena" << endl;
+        return false;
+    }
+    if(!sameParameters(job, makeJob(scene))) {
+        cerr << "Erro: o trabalho em " << dir << " tem outra resolução ou outros parâmetros de amostragem" << endl;
+        return false;
+    }
+
+    Framebuffer fb(scene.imgWidth, scene.imgHeight, Renderer::tileSize);
+    ThreadPool pool(scene.threads);
+    int rendered = 0;
+    for(int unit = 0; unit < job.unitCount; unit++) {
+        // Para assim que o coordenador encerra o trabalho (ou publica outro)
+        JobHeader current;
+        if(!readJob(dir, current) || current.id != job.id) break;
+        if(!claim(dir, job, unit)) continue;
+
+        Renderer::renderRows(scene, fb, unit * job.unitRows, unitRowTo(job, unit), pool);
+        if(!writePart(dir, job, unit, fb)) return false;
+        rendered++;
+    }
+
+    cerr << "Worker " << getpid() << ": " << rendered << " unidades renderizadas" << endl;
+    return true;
+}
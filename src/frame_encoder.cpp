@@ -0,0 +1,131 @@
+#include "frame_encoder.hpp"
+#include "color.hpp"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+bool FrameEncoder::open(const string& output, ImageFormat format, int width, int height, int fps) {
+    this->output = output;
+    this->format = format;
+    this->width = width;
+    this->height = height;
+    y4m = output.size() >= 4 && output.substr(output.size() - 4) == ".y4m";
+
+    if(y4m) {
+        video.open(output, ios::out | ios::binary | ios::trunc);
+        if(!video.is_open()) {
+            cerr << "Erro: Não foi possível criar o arquivo " << output << endl;
+            return false;
+        }
+        video << "YUV4MPEG2 W" << width << " H" << height << " F" << fps << ":1 Ip A1:1 C444\n";
+    }
+
+    worker = thread(&FrameEncoder::run, this);
+    return true;
+}
+
+unique_ptr<Framebuffer> FrameEncoder::acquire() {
+    unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !spare.empty() || allocated < bufferCount; });
+    if(spare.empty()) {
+        allocated++;
+        return make_unique<Framebuffer>(width, height);
+    }
+
+    unique_ptr<Framebuffer> fb = move(spare.back());
+    spare.pop_back();
+    lock.unlock();
+    fb->clear();
+    return fb;
+}
+
+void FrameEncoder::submit(int frame, unique_ptr<Framebuffer> fb) {
+    lock_guard<std::mutex> lock(mutex);
+    queue.push_back(Pending{frame, move(fb)});
+    changed.notify_all();
+}
+
+bool FrameEncoder::finish() {
+    if(worker.joinable()) {
+        {
+            lock_guard<std::mutex> lock(mutex);
+            closing = true;
+            changed.notify_all();
+        }
+        worker.join();
+    }
+    if(video.is_open()) {
+        video.close();
+        if(video.fail()) failed = true;
+    }
+    return !failed;
+}
+
+string FrameEncoder::framePath(int frame) const {
+    string extension = ImageWriter::extension(format);
+    string prefix = output;
+    if(prefix.size() >= extension.size() && prefix.substr(prefix.size() - extension.size()) == extension) {
+        prefix.resize(prefix.size() - extension.size());
+    }
+    char number[16];
+    snprintf(number, sizeof(number), "_%04d", frame);
+    return prefix + number + extension;
+}
+
+void FrameEncoder::run() {
+    while(true) {
+        Pending p;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this] { return !queue.empty() || closing; });
+            if(queue.empty()) return;
+            p = move(queue.front());
+            queue.pop_front();
+        }
+
+        // A gravação acontece fora da trava, enquanto o renderizador segue no próximo quadro
+        bool ok = write(p);
+
+        lock_guard<std::mutex> lock(mutex);
+        if(!ok) failed = true;
+        spare.push_back(move(p.fb));
+        changed.notify_all();
+    }
+}
+
+bool FrameEncoder::write(const Pending& p) {
+    if(y4m) return writeY4M(*p.fb);
+
+    unique_ptr<ImageWriter> writer = ImageWriter::create(format);
+    if(!writer->open(framePath(p.frame), width, height)) return false;
+    writer->writeRows(*p.fb, 0, height - 1);
+    return writer->close();
+}
+
+bool FrameEncoder::writeY4M(const Framebuffer& fb) {
+    // Planos Y, Cb e Cr completos (4:4:4), linha de cima primeiro, com as cores quantizadas como no PPM
+    size_t pixels = size_t(width) * height;
+    planes.resize(3 * pixels);
+    unsigned char* y = (unsigned char*)planes.data();
+    unsigned char* cb = y + pixels;
+    unsigned char* cr = cb + pixels;
+    for(int line = 0; line < height; line++) {
+        int row = height - 1 - line;
+        for(int col = 0; col < width; col++) {
+            color c = fb.resolve(row, col);
+            double r = quantize(c.x(), 255) / 255.0;
+            double g = quantize(c.y(), 255) / 255.0;
+            double b = quantize(c.z(), 255) / 255.0;
+            size_t i = size_t(line) * width + col;
+            y[i] = (unsigned char)lround(16 + 219 * (0.299 * r + 0.587 * g + 0.114 * b));
+            cb[i] = (unsigned char)lround(128 + 224 * (-0.168736 * r - 0.331264 * g + 0.5 * b));
+            cr[i] = (unsigned char)lround(128 + 224 * (0.5 * r - 0.418688 * g - 0.081312 * b));
+        }
+    }
+
+    video << "FRAME\n";
+    video.write(planes.data(), planes.size());
+    return !video.fail();
+}
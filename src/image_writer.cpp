@@ -0,0 +1,142 @@
+#include "image_writer.hpp"
+#include "color.hpp"
+#include <charconv>
+#include <cstdint>
+
+using namespace std;
+
+// P3: um pixel "r g b" por linha, como o formato original do programa
+class PpmAsciiWriter : public ImageWriter {
+    protected:
+        string header() const override {
+            return "P3\n" + to_string(width) + " " + to_string(height) + "\n255\n";
+        }
+
+        void encodeRow(const Framebuffer& fb, int row, vector<char>& out) const override {
+            size_t start = out.size();
+            out.resize(start + size_t(width) * 12);
+            char* p = out.data() + start;
+            for(int col = 0; col < width; col++) {
+                color c = fb.resolve(row, col);
+                for(int k = 0; k < 3; k++) {
+                    p = to_chars(p, p + 3, quantize(c[k], 255)).ptr;
+                    *p++ = k == 2 ? '\n' : ' ';
+                }
+            }
+            out.resize(p - out.data());
+        }
+};
+
+// P6: 8 bits por canal
+class PpmBinaryWriter : public ImageWriter {
+    protected:
+        string header() const override {
+            return "P6\n" + to_string(width) + " " + to_string(height) + "\n255\n";
+        }
+
+        void encodeRow(const Framebuffer& fb, int row, vector<char>& out) const override {
+            for(int col = 0; col < width; col++) {
+                color c = fb.resolve(row, col);
+                for(int k = 0; k < 3; k++) {
+                    out.push_back((char)quantize(c[k], 255));
+                }
+            }
+        }
+};
+
+// P6 com 16 bits por canal; o formato exige big-endian
+class Ppm16Writer : public ImageWriter {
+    protected:
+        string header() const override {
+            return "P6\n" + to_string(width) + " " + to_string(height) + "\n65535\n";
+        }
+
+        void encodeRow(const Framebuffer& fb, int row, vector<char>& out) const override {
+            for(int col = 0; col < width; col++) {
+                color c = fb.resolve(row, col);
+                for(int k = 0; k < 3; k++) {
+                    int v = quantize(c[k], 65535);
+                    out.push_back((char)(v >> 8));
+                    out.push_back((char)(v & 0xff));
+                }
+            }
+        }
+};
+
+// PFM: floats crus; escala negativa indica little-endian, positiva big-endian
+class PfmWriter : public ImageWriter {
+    public:
+        bool topDown() const override { return false; }
+
+    protected:
+        string header() const override {
+            const uint16_t probe = 1;
+            bool littleEndian = *(const uint8_t*)&probe == 1;
+            return "PF\n" + to_string(width) + " " + to_string(height) + "\n" + (littleEndian ? "-1.0" : "1.0") + "\n";
+        }
+
+        void encodeRow(const Framebuffer& fb, int row, vector<char>& out) const override {
+            size_t start = out.size();
+            out.resize(start + size_t(width) * 3 * sizeof(float));
+            float* p = (float*)(out.data() + start);
+            for(int col = 0; col < width; col++) {
+                color c = fb.resolve(row, col);
+                *p++ = (float)c.x();
+                *p++ = (float)c.y();
+                *p++ = (float)c.z();
+            }
+        }
+};
+
+unique_ptr<ImageWriter> ImageWriter::create(ImageFormat format) {
+    switch(format) {
+        case ImageFormat::PPM_ASCII: return make_unique<PpmAsciiWriter>();
+        case ImageFormat::PPM_16: return make_unique<Ppm16Writer>();
+        case ImageFormat::PFM: return make_unique<PfmWriter>();
+        default: return make_unique<PpmBinaryWriter>();
+    }
+}
+
+bool ImageWriter::parseFormat(const string& name, ImageFormat& format) {
+    if(name == "p3") format = ImageFormat::PPM_ASCII;
+    else if(name == "p6") format = ImageFormat::PPM_BINARY;
+    else if(name == "ppm16") format = ImageFormat::PPM_16;
+    else if(name == "pfm") format = ImageFormat::PFM;
+    else return false;
+    return true;
+}
+
+const char* ImageWriter::extension(ImageFormat format) {
+    return format == ImageFormat::PFM ? ".pfm" : ".ppm";
+}
+
+bool ImageWriter::open(const string& path, int width, int height) {
+    this->width = width;
+    this->height = height;
+
+    file.open(path, ios::out | ios::binary | ios::trunc);
+    if(!file.is_open()) {
+        cerr << "Erro: Não foi possível criar o arquivo " << path << endl;
+        return false;
+    }
+
+    string h = header();
+    file.write(h.data(), h.size());
+    return true;
+}
+
+void ImageWriter::writeRows(const Framebuffer& fb, int rowFrom, int rowTo) {
+    if(!file.is_open()) return;
+
+    buffer.clear();
+    for(int i = 0; i <= rowTo - rowFrom; i++) {
+        encodeRow(fb, topDown() ? rowTo - i : rowFrom + i, buffer);
+    }
+    file.write(buffer.data(), buffer.size());
+}
+
+bool ImageWriter::close() {
+    if(!file.is_open()) return false;
+    file.close();
+    return !file.fail();
+}
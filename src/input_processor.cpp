@@ -1,226 +1,240 @@
 #include "input_processor.hpp"
-#include "objects/sphere.hpp"
-#include "objects/polyhedron.hpp"
 #include <iostream>
+#include <stdexcept>
 
 using namespace std;
 
-SceneDescription InputProcessor::processFile(const string& filename) {
-    SceneDescription scene;
-    ifstream inputFile(filename);
+bool InputProcessor::processFile(const string& filename, SceneDescription& scene) {
+    MappedFile inputFile;
     
-    if (!inputFile.is_open()) {
+    if (!inputFile.open(filename)) {
         cerr << "Erro: Não foi possível abrir o arquivo " << filename << endl;
-        return scene;
+        return false;
     }
     
-    // Processa cada seção do arquivo de entrada
-    parseCameraSettings(inputFile, scene);
-    parseLights(inputFile, scene);
-    parsePigments(inputFile, scene);
-    parseMaterials(inputFile, scene);
-    parseObjects(inputFile, scene);
-    parseFocusSettings(inputFile, scene);
+    // Cena binária (ver SceneFile): os registros são usados direto do arquivo mapeado
+    if(SceneFile::isBinary(inputFile.contents())) {
+        SceneView view;
+        if(!SceneFile::read(inputFile.contents(), view)) {
+            cerr << "Erro em " << filename << endl;
+            return false;
+        }
+        SceneFile::instantiate(view, scene);
+        return true;
+    }
     
-    inputFile.close();
-    return scene;
+    SceneData data;
+    if(!parseFile(inputFile.contents(), filename, data)) return false;
+    SceneFile::instantiate(data.view(), scene);
+    return true;
 }
 
-void InputProcessor::parseCameraSettings(ifstream& file, SceneDescription& scene) {
-    string line;
-    
+bool InputProcessor::parseFile(string_view contents, const string& filename, SceneData& data) {
+    // Processa cada seção do arquivo de entrada, direto do arquivo mapeado em memória
+    TextReader reader(contents);
+    try {
+        parseCameraSettings(reader, data);
+        parseLights(reader, data);
+        parsePigments(reader, data);
+        parseMaterials(reader, data);
+        parseObjects(reader, data);
+        parseFocusSettings(reader, data);
+    } catch(const runtime_error& e) {
+        cerr << "Erro em " << filename << ", " << e.what() << endl;
+        return false;
+    }
+    return true;
+}
+
+// Próxima linha do arquivo; o formato não tem seções opcionais antes da profundidade de campo
+static void requireLine(TextReader& reader) {
+    if(!reader.nextLine()) {
+        throw runtime_error("linha " + to_string(reader.lineNumber() + 1) + ": fim do arquivo inesperado");
+    }
+}
+
+// Lê count números da linha atual
+static void readNumbers(TextReader& reader, double* out, int count) {
+    for(int i = 0; i < count; i++) {
+        out[i] = reader.number();
+    }
+}
+
+void InputProcessor::parseCameraSettings(TextReader& reader, SceneData& data) {
     // Lê posição da câmera (lookFrom)
-    getline(file, line);
-    scene.lookFrom = p3(line);
+    requireLine(reader);
+    readNumbers(reader, data.camera.lookFrom, 3);
     
     // Lê ponto para onde a câmera está olhando (lookAt)
-    getline(file, line);
-    scene.lookAt = p3(line);
+    requireLine(reader);
+    readNumbers(reader, data.camera.lookAt, 3);
     
     // Lê vetor "up" da câmera
-    getline(file, line);
-    scene.vUp = p3(line);
+    requireLine(reader);
+    readNumbers(reader, data.camera.vUp, 3);
     
     // Lê campo de visão vertical (vFov)
-    getline(file, line);
-    scene.vFov = stod(line);
+    requireLine(reader);
+    data.camera.vFov = reader.number();
 }
 
-void InputProcessor::parseLights(ifstream& file, SceneDescription& scene) {
-    string line;
-    
+void InputProcessor::parseLights(TextReader& reader, SceneData& data) {
     // Lê número de luzes
-    getline(file, line);
-    int numLights = stoi(line);
+    requireLine(reader);
+    int numLights = reader.integer();
     
     // Processa cada luz
     for(int i = 0; i < numLights; i++) {
-        getline(file, line);
-        vector<string> lightDetails = split(line);
+        requireLine(reader);
+        LightRecord light;
         
         // Posição da luz (x, y, z)
-        p3 lightPos = p3(stod(lightDetails[0]), stod(lightDetails[1]), stod(lightDetails[2]));
+        readNumbers(reader, light.position, 3);
         
         // Cor da luz (r, g, b)
-        p3 lightColor = p3(stod(lightDetails[3]), stod(lightDetails[4]), stod(lightDetails[5]));
+        readNumbers(reader, light.color, 3);
         
-        // Coeficientes de atenuação da luz
-        double attenuationConstant = stod(lightDetails[6]);  // Constante
-        double attenuationLinear = stod(lightDetails[7]);    // Linear (proporcional à distância)
-        double attenuationQuadratic = stod(lightDetails[8]); // Quadrático (proporcional ao quadrado da distância)
+        // Coeficientes de atenuação da luz: constante, linear (proporcional à distância) e
+        // quadrático (proporcional ao quadrado da distância)
+        readNumbers(reader, light.attenuation, 3);
         
-        LightMaterialPtr lightMaterial = make_shared<LightMaterial>(
-            lightColor, attenuationConstant, attenuationLinear, attenuationQuadratic, true
-        );
-        scene.lights.push_back(Light(lightPos, lightMaterial));
+        data.lights.push_back(light);
     }
 }
 
-void InputProcessor::parsePigments(ifstream& file, SceneDescription& scene) {
-    string line;
-    
+void InputProcessor::parsePigments(TextReader& reader, SceneData& data) {
     // Lê número de pigmentos
-    getline(file, line);
-    int numPigments = stoi(line);
+    requireLine(reader);
+    int numPigments = reader.integer();
     
     // Processa cada pigmento
     for(int i = 0; i < numPigments; i++) {
-        getline(file, line);
-        vector<string> pigmentDetails = split(line);
+        requireLine(reader);
+        string_view type = reader.word();
+        PigmentRecord pigment = PigmentRecord();
         
-        if(pigmentDetails[0] == "solid") {
+        if(type == "solid") {
             // Pigmento de cor sólida
-            color pigmentColor = p3(stod(pigmentDetails[1]), stod(pigmentDetails[2]), stod(pigmentDetails[3]));
-            scene.pigments.push_back(make_shared<SolidColor>(pigmentColor));
+            pigment.type = PigmentType::Solid;
+            readNumbers(reader, pigment.color1, 3);
+            data.pigments.push_back(pigment);
             
-        } else if(pigmentDetails[0] == "textmap" || pigmentDetails[0] == "texmap") {
+        } else if(type == "textmap" || type == "texmap") {
             // Textura de imagem mapeada
-            string image = pigmentDetails[1];
-            vector<string> coords;
+            string_view image = reader.word();
+            pigment.type = PigmentType::Image;
+            pigment.nameOffset = data.names.size();
+            pigment.nameLength = image.size();
+            data.names += image;
             
             // Lê primeiro ponto de mapeamento (u, v, s, t)
-            getline(file, line);
-            coords = split(line);
-            vec4 tmP0 = vec4(stod(coords[0]), stod(coords[1]), stod(coords[2]), stod(coords[3]));
+            requireLine(reader);
+            readNumbers(reader, pigment.p0, 4);
             
             // Lê segundo ponto de mapeamento
-            getline(file, line);
-            coords = split(line);
-            vec4 tmP1 = vec4(stod(coords[0]), stod(coords[1]), stod(coords[2]), stod(coords[3]));
+            requireLine(reader);
+            readNumbers(reader, pigment.p1, 4);
             
-            scene.pigments.push_back(make_shared<ImageTexturePs>(image.c_str(), tmP0, tmP1));
+            data.pigments.push_back(pigment);
             
-        } else if(pigmentDetails[0] == "checker") {
+        } else if(type == "checker") {
             // Padrão xadrez (checker)
-            color c1 = p3(stod(pigmentDetails[1]), stod(pigmentDetails[2]), stod(pigmentDetails[3]));
-            color c2 = p3(stod(pigmentDetails[4]), stod(pigmentDetails[5]), stod(pigmentDetails[6]));
-            double size = stod(pigmentDetails[7]);
-            
-            CheckerTexturePtr checker = make_shared<CheckerTexture>(c1, c2);
-            checker->setSize(size);
-            scene.pigments.push_back(checker);
+            pigment.type = PigmentType::Checker;
+            readNumbers(reader, pigment.color1, 3);
+            readNumbers(reader, pigment.color2, 3);
+            pigment.size = reader.number();
+            data.pigments.push_back(pigment);
         }
     }
 }
 
-void InputProcessor::parseMaterials(ifstream& file, SceneDescription& scene) {
-    string line;
-    
+void InputProcessor::parseMaterials(TextReader& reader, SceneData& data) {
     // Lê número de materiais
-    getline(file, line);
-    int numMaterials = stoi(line);
+    requireLine(reader);
+    int numMaterials = reader.integer();
     
     // Processa cada material
     for(int i = 0; i < numMaterials; i++) {
-        getline(file, line);
-        vector<string> materialDetails = split(line);
+        requireLine(reader);
+        MaterialRecord material;
         
         // Coeficientes do modelo de iluminação
-        double ka = stod(materialDetails[0]);    // Coeficiente de luz ambiente
-        double kd = stod(materialDetails[1]);    // Coeficiente de luz difusa
-        double ks = stod(materialDetails[2]);    // Coeficiente de luz especular
-        double alpha = stod(materialDetails[3]); // Expoente para reflexão especular (brilho)
+        material.ka = reader.number();    // Coeficiente de luz ambiente
+        material.kd = reader.number();    // Coeficiente de luz difusa
+        material.ks = reader.number();    // Coeficiente de luz especular
+        material.alpha = reader.number(); // Expoente para reflexão especular (brilho)
         
         // Propriedades de reflexão e refração
-        double kr = stod(materialDetails[4]);  // Coeficiente de reflexão
-        double kt = stod(materialDetails[5]);  // Coeficiente de transmissão (refração)
-        double ior = stod(materialDetails[6]); // Índice de refração
+        material.kr = reader.number();  // Coeficiente de reflexão
+        material.kt = reader.number();  // Coeficiente de transmissão (refração)
+        material.ior = reader.number(); // Índice de refração
         
         // Parâmetro de "fuziness" (imperfeição) - opcional
-        double fuziness = 0;
-        if(materialDetails.size() > 7) {
-            fuziness = stod(materialDetails[7]);
+        material.fuzz = 0;
+        if(reader.hasMore()) {
+            material.fuzz = reader.number();
         }
         
-        GenericMaterialPtr matPtr = make_shared<GenericMaterial>(ka, kd, ks, alpha, kr, kt, ior, fuziness);
-        scene.materials.push_back(matPtr);
+        data.materials.push_back(material);
     }
 }
 
-void InputProcessor::parseObjects(ifstream& file, SceneDescription& scene) {
-    string line;
-    
+void InputProcessor::parseObjects(TextReader& reader, SceneData& data) {
     // Lê número de objetos
-    getline(file, line);
-    int numObjects = stoi(line);
+    requireLine(reader);
+    int numObjects = reader.integer();
     
     // Processa cada objeto
     for(int i = 0; i < numObjects; i++) {
-        getline(file, line);
-        vector<string> objectDetails = split(line);
+        requireLine(reader);
+        ObjectRecord object = ObjectRecord();
         
         // Índices do pigmento e material a serem usados
-        int pigmentIndex = stoi(objectDetails[0]);
-        int materialIndex = stoi(objectDetails[1]);
-        string objectType = objectDetails[2];
-        
-        // Cria material com o pigmento apropriado
-        GenericMaterial mat = *scene.materials[materialIndex];
-        mat.col = scene.pigments[pigmentIndex];
-        GenericMaterialPtr matPtr = make_shared<GenericMaterial>(mat);
+        object.pigment = reader.integer();
+        object.material = reader.integer();
+        string_view objectType = reader.word();
+        if(object.pigment < 0 || object.pigment >= (int)data.pigments.size() ||
+           object.material < 0 || object.material >= (int)data.materials.size()) {
+            throw runtime_error("linha " + to_string(reader.lineNumber()) + ": pigmento ou material inexistente");
+        }
         
         if(objectType == "sphere") {
             // Esfera: centro (x, y, z) e raio
-            p3 center = p3(stod(objectDetails[3]), stod(objectDetails[4]), stod(objectDetails[5]));
-            double radius = stod(objectDetails[6]);
-            scene.componentList.add(make_shared<Sphere>(center, radius, matPtr));
+            object.type = ObjectType::Sphere;
+            readNumbers(reader, object.sphere, 4);
+            data.objects.push_back(object);
             
         } else if(objectType == "polyhedron") {
             // Poliedro: definido por múltiplas faces planas
-            int numFaces = stoi(objectDetails[3]);
-            PolyhedronPtr poly = make_shared<Polyhedron>(matPtr);
+            int numFaces = reader.integer();
+            object.type = ObjectType::Polyhedron;
+            object.faceFirst = data.faces.size();
             
             // Lê cada face do poliedro (plano definido por ax + by + cz + d = 0)
             for(int j = 0; j < numFaces; j++) {
-                getline(file, line);
-                vector<string> faceDetails = split(line);
+                requireLine(reader);
                 
-                double c1 = stod(faceDetails[0]);
-                double c2 = stod(faceDetails[1]);
-                double c3 = stod(faceDetails[2]);
-                double c4 = stod(faceDetails[3]);
-                Plane p = Plane(c1, c2, c3, c4);
-                poly->addFace(p);
+                FaceRecord face;
+                face.a = reader.number();
+                face.b = reader.number();
+                face.c = reader.number();
+                face.d = reader.number();
+                data.faces.push_back(face);
             }
-            scene.componentList.add(poly);
+            object.faceCount = data.faces.size() - object.faceFirst;
+            data.objects.push_back(object);
         }
     }
 }
 
-void InputProcessor::parseFocusSettings(ifstream& file, SceneDescription& scene) {
-    string line;
-    
-    // Lê configurações opcionais de abertura e distância focal
-    if(getline(file, line)) {
-        vector<string> focusDetails = split(line);
-        if(focusDetails.size() >= 2) {
-            scene.aperture = stod(focusDetails[0]);
-            scene.distToFocus = stod(focusDetails[1]);
+void InputProcessor::parseFocusSettings(TextReader& reader, SceneData& data) {
+    // Lê configurações opcionais de abertura e distância focal. Linhas adicionais no arquivo
+    // (se houver) são ignoradas.
+    if(reader.nextLine() && reader.hasMore()) {
+        double aperture = reader.number();
+        if(reader.hasMore()) {
+            data.camera.aperture = aperture;
+            data.camera.distToFocus = reader.number();
         }
     }
-    
-    // Ignora linhas adicionais no arquivo (se houver)
-    while(getline(file, line)) {
-        // Apenas consome linhas extras
-    }
 }
@@ -1,90 +1,190 @@
 #include "renderer.hpp"
+#include "checkpoint.hpp"
+#include <chrono>
+#include <filesystem>
 #include <iostream>
-#include <fstream>
-#include <thread>
 #include <vector>
+#include <functional>
+#include <algorithm>
+#include <mutex>
 
 using namespace std;
 
-// Inicialização de variáveis estáticas
-int Renderer::remainingRows = 0;
+atomic<uint64_t> Renderer::totalRays(0);
 
-void Renderer::render(const SceneDescription& scene, const string& outputFile) {
+// Raios traçados pela thread desde o fim do último bloco; somados a totalRays bloco a bloco, para
+// não disputar o contador atômico a cada raio
+static thread_local uint64_t tileRays = 0;
+
+bool Renderer::render(const SceneDescription& scene, const string& outputFile) {
+    ThreadPool pool(scene.threads);
+    return render(scene, outputFile, pool);
+}
+
+bool Renderer::render(const SceneDescription& scene, const string& outputFile, ThreadPool& pool) {
     // Cria a câmera com os parâmetros da cena
     Camera camera(scene.lookFrom, scene.lookAt, scene.vUp, scene.vFov, 
                  scene.aspectRatio, scene.aperture, scene.distToFocus);
     
-    // Aloca memória para a imagem
-    color** img = new color*[scene.imgHeight];
-    for(int i = 0; i < scene.imgHeight; i++) {
-        img[i] = new color[scene.imgWidth];
-        for(int j = 0; j < scene.imgWidth; j++) {
-            img[i][j] = color(0, 0, 0);
-        }
-    }
+    // Buffer contíguo da imagem, com blocos alinhados às linhas de cache
+    Framebuffer fb(scene.imgWidth, scene.imgHeight, tileSize);
     
-    // Abre arquivo de saída
-    ofstream output;
-    output.open(outputFile);
+    // Amostras por pixel já pedidas pelas passadas concluídas (de uma execução anterior, ao retomar)
+    int samplesDone = 0;
+    if(!scene.resumeFile.empty()) {
+        if(!Checkpoint::load(scene.resumeFile, scene, fb, samplesDone)) return false;
+        cerr << "Retomando de " << scene.resumeFile << " (" << samplesDone << " amostras por pixel)\n";
+    }
     
-    // Escreve cabeçalho PPM
-    output << "P3\n" << scene.imgWidth << " " << scene.imgHeight << "\n255\n";
+    // Renderização progressiva: passadas de passSamples amostras por pixel, cada uma regravando a
+    // imagem e, a cada checkpointInterval segundos, o ponto de controle
+    int totalSamples = scene.noiseThreshold > 0 ? scene.maxSamples : scene.samplesPerPixel;
+    int passSamples = scene.passSamples > 0 ? scene.passSamples : totalSamples;
+    auto lastCheckpoint = chrono::steady_clock::now();
     
-    // Inicializa contador de progresso
-    remainingRows = scene.imgHeight;
+    do {
+        int target = min(samplesDone + passSamples, totalSamples);
+        if(passSamples < totalSamples) {
+            cerr << "Passada: " << samplesDone << " -> " << target << " amostras por pixel\n";
+        }
+        if(!renderPass(scene, camera, fb, target, outputFile, pool, 0, scene.imgHeight - 1)) return false;
+        samplesDone = max(samplesDone, target);
+        
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - lastCheckpoint).count();
+        if(!scene.checkpointFile.empty() && (samplesDone == totalSamples || elapsed >= scene.checkpointInterval)) {
+            if(!Checkpoint::save(scene.checkpointFile, scene, fb, samplesDone)) return false;
+            lastCheckpoint = chrono::steady_clock::now();
+        }
+    } while(samplesDone < totalSamples);
     
-    // Cria threads para renderização paralela
-    vector<thread*> threads;
-    printRemaining();
+    if(scene.noiseThreshold > 0) {
+        return reportSamples(fb, scene);
+    }
+    return true;
+}
+
+void Renderer::renderFrame(const SceneDescription& scene, Framebuffer& fb, ThreadPool& pool) {
+    Camera camera(scene.lookFrom, scene.lookAt, scene.vUp, scene.vFov, 
+                 scene.aspectRatio, scene.aperture, scene.distToFocus);
+    int totalSamples = scene.noiseThreshold > 0 ? scene.maxSamples : scene.samplesPerPixel;
+    renderPass(scene, camera, fb, totalSamples, "", pool, 0, scene.imgHeight - 1);
+}
+
+void Renderer::renderRows(const SceneDescription& scene, Framebuffer& fb, int rowFrom, int rowTo, ThreadPool& pool) {
+    Camera camera(scene.lookFrom, scene.lookAt, scene.vUp, scene.vFov, 
+                 scene.aspectRatio, scene.aperture, scene.distToFocus);
+    int totalSamples = scene.noiseThreshold > 0 ? scene.maxSamples : scene.samplesPerPixel;
+    renderPass(scene, camera, fb, totalSamples, "", pool, rowFrom, rowTo);
+}
+
+bool Renderer::write(const SceneDescription& scene, const Framebuffer& fb, const string& outputFile) {
+    unique_ptr<ImageWriter> writer = ImageWriter::create(scene.outputFormat);
+    if(!writer->open(outputFile, scene.imgWidth, scene.imgHeight)) return false;
+    writer->writeRows(fb, 0, scene.imgHeight - 1);
+    if(!writer->close()) return false;
     
-    // Divide o trabalho em lotes para paralelização
-    int batchSize = scene.imgHeight / 20;
-    for(int row = scene.imgHeight; row >= 0; row -= batchSize) {
-        int from = row - batchSize < 0 ? 0 : row - batchSize;
-        int to = row - 1 < 0 ? 0 : row - 1;
-        
-        thread* th = new thread(computeFor, from, to, img, scene.imgWidth, scene.imgHeight,
-                               scene.samplesPerPixel, ref(camera), 
-                               ref(scene.componentList), ref(scene.lights));
-        threads.push_back(th);
+    if(scene.noiseThreshold > 0) {
+        return reportSamples(fb, scene);
+    }
+    return true;
+}
+
+bool Renderer::renderPass(const SceneDescription& scene, const Camera& camera, Framebuffer& fb, int target,
+                          const string& outputFile, ThreadPool& pool, int rowFrom, int rowTo) {
+    // Abre a saída no formato escolhido (sem arquivo, a imagem fica só no framebuffer), num arquivo
+    // temporário que só substitui outputFile quando a passada termina. Saídas que não são arquivos
+    // comuns (/dev/null, /dev/stdout, pipes, links simbólicos) são gravadas diretamente.
+    unique_ptr<ImageWriter> writer;
+    error_code ec;
+    filesystem::file_status status = filesystem::symlink_status(outputFile, ec);
+    bool replace = !filesystem::exists(status) || filesystem::is_regular_file(status);
+    string temp = replace ? outputFile + ".tmp" : outputFile;
+    if(!outputFile.empty()) {
+        writer = ImageWriter::create(scene.outputFormat);
+        if(!writer->open(temp, scene.imgWidth, scene.imgHeight)) return false;
     }
     
-    // Aguarda todas as threads terminarem
-    for(auto th : threads) {
-        th->join();
-        delete th;
+    // Cada faixa horizontal de blocos é gravada assim que todos os seus blocos terminam,
+    // respeitando a ordem das linhas no arquivo, enquanto as demais faixas continuam renderizando
+    int bandCount = (scene.imgHeight + tileSize - 1) / tileSize;
+    int tilesPerBand = (scene.imgWidth + tileSize - 1) / tileSize;
+    vector<atomic<int>> bandRemaining(bandCount);
+    for(auto& remaining : bandRemaining) {
+        remaining = tilesPerBand;
     }
+    vector<bool> bandDone(bandCount, false);
+    int nextBand = 0; // Próxima faixa a gravar, contada na ordem do arquivo
+    mutex writeMutex;
+    atomic<int> remainingTiles(0);
+    
+    auto finishBand = [&](int band) {
+        if(!writer) return;
+        lock_guard<mutex> lock(writeMutex);
+        bandDone[band] = true;
+        while(nextBand < bandCount) {
+            int b = writer->topDown() ? bandCount - 1 - nextBand : nextBand;
+            if(!bandDone[b]) break;
+            writer->writeRows(fb, b * tileSize, min((b + 1) * tileSize, scene.imgHeight) - 1);
+            nextBand++;
+        }
+    };
     
-    // Escreve pixels no arquivo de saída (de cima para baixo)
-    for(int row = scene.imgHeight - 1; row >= 0; --row) {
-        for(int col = 0; col < scene.imgWidth; ++col) {
-            outputColor(output, img[row][col], scene.samplesPerPixel);
+    // Divide a imagem em blocos pequenos; as threads do pool equilibram a carga roubando blocos
+    // umas das outras, então regiões caras não ficam concentradas numa única thread
+    vector<function<void()>> tasks;
+    for(int row = rowFrom; row <= rowTo; row += tileSize) {
+        for(int col = 0; col < scene.imgWidth; col += tileSize) {
+            Tile tile = {row, min(row + tileSize - 1, rowTo),
+                         col, min(col + tileSize, scene.imgWidth) - 1};
+            int band = row / tileSize;
+            tasks.push_back([=, &fb, &camera, &scene, &bandRemaining, &finishBand, &remainingTiles]() {
+                computeFor(tile, fb, scene, camera, target);
+                totalRays += tileRays;
+                tileRays = 0;
+                if(--bandRemaining[band] == 0) {
+                    finishBand(band);
+                }
+                
+                // Atualiza progresso
+                int remaining = --remainingTiles;
+                if(scene.showProgress) printRemaining(remaining);
+            });
         }
     }
     
-    cerr << "\nConcluído.\n";
+    // Contador de progresso desta renderização (outras podem estar usando o mesmo pool)
+    remainingTiles = tasks.size();
+    if(scene.showProgress) printRemaining(remainingTiles);
     
-    // Libera memória
-    for(int i = 0; i < scene.imgHeight; i++) {
-        delete[] img[i];
+    // Renderiza todos os blocos e aguarda o término (as faixas já foram gravadas durante a renderização)
+    pool.run(tasks);
+    bool written = !writer || writer->close();
+    if(writer && !written) {
+        cerr << "Erro: Não foi possível gravar o arquivo " << temp << endl;
+    } else if(writer && replace) {
+        filesystem::rename(temp, outputFile, ec);
+        if(ec) {
+            cerr << "Erro: Não foi possível substituir " << outputFile << ": " << ec.message() << endl;
+            written = false;
+        }
     }
-    delete[] img;
     
-    output.close();
+    if(scene.showProgress) cerr << "\nConcluído.\n";
+    return written;
 }
 
-void Renderer::lightMultiplier(const Ray& r, HitRecord hr, const vector<Light>& lights,
+void Renderer::lightMultiplier(const Ray& r, const HitRecord& hr, const vector<Light>& lights,
                                v3& diffuseColor, v3& specularColor, 
                                const ComponentList& componentList) {
     p3 hitPoint = hr.p;
-    MaterialPtr hitMat = hr.matPtr;
+    const Material* hitMat = hr.matPtr;
     
     v3 diffuseC = color(0, 0, 0);
     v3 specularC = color(0, 0, 0);
     
     // Itera sobre todas as luzes (pula a primeira que é a luz ambiente)
     for(size_t i = 1; i < lights.size(); i++) {
-        Light light = lights[i];
+        const Light& light = lights[i];
         
         // Usa uma cópia local do ponto de hit para aplicar jitter
         p3 p = hitPoint;
@@ -100,26 +200,15 @@ void Renderer::lightMultiplier(const Ray& r, HitRecord hr, const vector<Light>&
         }
         
         vec3 normalizedLightDir = lightDir.normalize();
-        HitRecord hr2;
         
-        // Verifica se há algum objeto bloqueando a luz (sombra)
-        bool didHit = const_cast<ComponentList&>(componentList).hit(
-            Ray(p, lightDir), 0.001, infinity, hr2, true
-        );
-        
-        bool inShadow = true;
-        if(!didHit) {
-            inShadow = false;
-        } else {
-            double distanceToHit = (hr2.p - p).length();
-            if(distanceToHit > distanceToLight) {
-                inShadow = false;
-            }
-        }
+        // Verifica se há algum objeto bloqueando a luz (sombra). O raio tem direção lightDir sem
+        // normalizar, então t = distanceToLight / |lightDir| corresponde à distância da luz.
+        bool inShadow = componentList.occluded(Ray(p, lightDir), rayEpsilon, distanceToLight / lightDir.length());
+        tileRays++;
         
         // Se não está na sombra, calcula contribuição da luz
         if(!inShadow) {
-            LightMaterialPtr lightMat = light.matPtr;
+            const LightMaterial* lightMat = light.matPtr.get();
             
             // Calcula atenuação baseada na distância
             double attenuation = 1.0 / (
@@ -145,69 +234,201 @@ void Renderer::lightMultiplier(const Ray& r, HitRecord hr, const vector<Light>&
 }
 
 color Renderer::rayColor(const Ray& r, const ComponentList& componentList,
-                         const vector<Light>& lights, int maxDep, color bg) {
-    // Limite de profundidade de recursão atingido
-    if(maxDep <= 0) {
-        return color(1, 1, 1);
-    }
-    
+                         const vector<Light>& lights, int maxDepth, int rouletteDepth, const color& bg,
+                         double pixelSpread, const PrimaryHit* primary) {
+    // Integrador iterativo: em vez de recursão, carrega adiante o produto das atenuações do caminho
+    // (throughput) e acumula em result a contribuição de cada interação
+    color result(0, 0, 0);
+    color throughput(1, 1, 1);
+    Ray ray = r;
     HitRecord hr;
-    if(const_cast<ComponentList&>(componentList).hit(r, 0.001, infinity, hr, maxDep < maxDepth)) {
+    double pathLength = 0; // distância percorrida desde a câmera, para a largura do cone do raio
+    
+    for(int depth = 0; ; depth++) {
+        // Limite de profundidade atingido
+        if(depth >= maxDepth) {
+            result += throughput * color(1, 1, 1);
+            break;
+        }
+        
+        // Não acertou nada, soma a cor de fundo
+        tileRays++;
+        bool hitAnything;
+        if(depth == 0 && primary) {
+            hitAnything = primary->hit;
+            hr = primary->rec;
+        } else {
+            hitAnything = componentList.hit(ray, rayEpsilon, infinity, hr, depth > 0);
+        }
+        if(!hitAnything) {
+            result += throughput * bg;
+            break;
+        }
+        
+        // Cone do raio: abre pixelSpread radianos por unidade percorrida (a curvatura das superfícies
+        // refletoras é ignorada); a largura no ponto escolhe o nível de mipmap das texturas
+        pathLength += hr.t * ray.dir.length();
+        hr.footprint.width = pixelSpread * pathLength;
+        
         Ray scattered;
         color attenuation;
         bool isLight = false;
         
         // Calcula iluminação (difusa e especular)
         v3 diffuseColor, specularColor;
-        lightMultiplier(r, hr, lights, diffuseColor, specularColor, componentList);
+        lightMultiplier(ray, hr, lights, diffuseColor, specularColor, componentList);
         
         // Calcula luz ambiente
         v3 ambientLight = (hr.matPtr->ambientLightCoefficient * lights[0].matPtr->col).sqrtv();
         
-        // Se o material espalha o raio (reflexão/refração)
-        if(hr.matPtr->scatter(r, hr, attenuation, scattered, isLight)) {
-            // Recursivamente traça o raio espalhado
-            vec3 target = rayColor(scattered, componentList, lights, maxDep - 1, bg);
-            return attenuation * target * (diffuseColor + ambientLight) + specularColor;
-        } else {
-            return attenuation * (diffuseColor + ambientLight) + specularColor;
+        // Se o material não espalha o raio (reflexão/refração), o caminho termina aqui
+        if(!hr.matPtr->scatter(ray, hr, attenuation, scattered, isLight)) {
+            result += throughput * (attenuation * (diffuseColor + ambientLight) + specularColor);
+            break;
+        }
+        
+        // Equivale a attenuation * rayColor(scattered) * (diffuse + ambient) + specular na versão recursiva
+        result += throughput * specularColor;
+        throughput = throughput * attenuation * (diffuseColor + ambientLight);
+        ray = scattered;
+        
+        // Roleta russa: depois de rouletteDepth interações, caminhos de pouca contribuição são
+        // encerrados com probabilidade 1 - p, e os sobreviventes compensados dividindo por p
+        if(depth + 1 >= rouletteDepth) {
+            double p = clamp(fmax(throughput.x(), fmax(throughput.y(), throughput.z())), 0.05, 1.0);
+            if(randomDouble() >= p) break;
+            throughput /= p;
         }
-    } else {
-        // Não acertou nada, retorna cor de fundo
-        return bg;
     }
+    
+    return result;
 }
 
-void Renderer::computeFor(int rowFrom, int rowTo, color** img, int imgWidth, int imgHeight,
-                         int samplesPerPixel, const Camera& camera,
-                         const ComponentList& componentList, const vector<Light>& lights) {
-    // Renderiza cada pixel do intervalo de linhas atribuído
-    for(int row = rowFrom; row <= rowTo; row++) {
-        for(int col = 0; col < imgWidth; ++col) {
-            color pixelColor(0, 0, 0);
+void Renderer::computeFor(const Tile& tile, Framebuffer& fb, const SceneDescription& scene,
+                         const Camera& camera, int target) {
+    // Renderiza cada pixel do bloco atribuído, continuando das amostras que ele já tem
+    for(int row = tile.rowFrom; row <= tile.rowTo; row++) {
+        for(int col = tile.colFrom; col <= tile.colTo; ++col) {
+            int n = fb.sampleCount(row, col);
+            if(scene.noiseThreshold <= 0) {
+                // Anti-aliasing: múltiplas amostras por pixel
+                if(n < target) samplePixel(row, col, n, target - n, fb, scene, camera);
+                continue;
+            }
             
-            // Anti-aliasing: múltiplas amostras por pixel
-            for(int s = 0; s < samplesPerPixel; ++s) {
-                auto u = double(col + randomDouble()) / (imgWidth - 1);
-                auto v = double(row + randomDouble()) / (imgHeight - 1);
-                
-                // Lança um raio para este pixel
-                Ray r = const_cast<Camera&>(camera).getRay(u, v);
-                
-                // Cor de fundo (cinza)
-                color background = color(0.31, 0.31, 0.31);
-                color c = rayColor(r, componentList, lights, maxDepth, background);
-                pixelColor += c;
+            // Amostragem adaptativa: depois de minSamples, continua em lotes enquanto o erro padrão
+            // da média da luminância do pixel estiver acima do limiar, até target
+            int minSamples = min(scene.minSamples, target);
+            if(n < minSamples) {
+                samplePixel(row, col, n, minSamples - n, fb, scene, camera);
+                n = minSamples;
+            }
+            int batch = max(scene.packetSize, 1);
+            while(n < target && fb.standardError(row, col) > scene.noiseThreshold) {
+                int count = min(batch, target - n);
+                samplePixel(row, col, n, count, fb, scene, camera);
+                n += count;
             }
-            img[row][col] += pixelColor;
         }
+    }
+
+}
+
+void Renderer::samplePixel(int row, int col, int first, int count, Framebuffer& fb,
+                           const SceneDescription& scene, const Camera& camera) {
+    int imgWidth = scene.imgWidth;
+    int imgHeight = scene.imgHeight;
+    
+    // Cor de fundo (cinza)
+    color background = color(0.31, 0.31, 0.31);
+    
+    // Ângulo coberto por um pixel, abertura inicial do cone de cada raio
+    double pixelSpread = 2 * tan(degreesToRadians(scene.vFov) / 2) / imgHeight;
+    
+    if(scene.packetSize <= 1) {
+        for(int s = first; s < first + count; ++s) {
+            // Cada amostra tem sua própria sequência aleatória, reprodutível pela semente
+            Random::seedFor(scene.seed, uint64_t(row) * imgWidth + col, s);
+            
+            auto u = double(col + randomDouble()) / (imgWidth - 1);
+            auto v = double(row + randomDouble()) / (imgHeight - 1);
+            
+            // Lança um raio para este pixel
+            Ray r = const_cast<Camera&>(camera).getRay(u, v);
+            
+            color c = rayColor(r, scene.componentList, scene.lights, scene.maxDepth,
+                               scene.rouletteDepth, background, pixelSpread);
+            fb.addSample(row, col, c);
+        }
+        return;
+    }
+    
+    int packetSize = min(scene.packetSize, RayPacket::maxSize);
+    RayPacket packet;
+    Random::State states[RayPacket::maxSize];
+    PrimaryHit primary[RayPacket::maxSize];
+    HitRecord recs[RayPacket::maxSize];
+    
+    // As amostras de um pixel saem quase do mesmo ponto na mesma direção: são traçadas juntas
+    // até a primeira interseção, e o restante de cada caminho segue raio a raio
+    for(int from = first; from < first + count; from += packetSize) {
+        int size = min(packetSize, first + count - from);
+        packet.clear();
+        
+        // Gera os raios com a mesma sequência aleatória do modo sem pacotes e guarda o estado
+        // do gerador de cada amostra para continuar o caminho dela depois
+        for(int s = from; s < from + size; s++) {
+            Random::seedFor(scene.seed, uint64_t(row) * imgWidth + col, s);
+            auto u = double(col + randomDouble()) / (imgWidth - 1);
+            auto v = double(row + randomDouble()) / (imgHeight - 1);
+            packet.add(const_cast<Camera&>(camera).getRay(u, v));
+            states[s - from] = Random::getState();
+        }
+        packet.finish();
+        
+        int hitMask = scene.componentList.hitPacket(packet, rayEpsilon, infinity, recs, false);
         
-        // Atualiza progresso
-        remainingRows--;
-        printRemaining();
+        for(int i = 0; i < size; i++) {
+            primary[i].hit = (hitMask >> i) & 1;
+            primary[i].rec = recs[i];
+            Random::setState(states[i]);
+            color c = rayColor(packet.rays[i], scene.componentList, scene.lights, scene.maxDepth,
+                               scene.rouletteDepth, background, pixelSpread, &primary[i]);
+            fb.addSample(row, col, c);
+        }
+    }
+}
+
+bool Renderer::reportSamples(const Framebuffer& fb, const SceneDescription& scene) {
+    // Mapa de calor: azul (minSamples) -> verde -> vermelho (maxSamples)
+    Framebuffer heat(scene.imgWidth, scene.imgHeight, tileSize);
+    double range = max(scene.maxSamples - scene.minSamples, 1);
+    uint64_t total = 0;
+    for(int row = 0; row < scene.imgHeight; row++) {
+        for(int col = 0; col < scene.imgWidth; col++) {
+            uint32_t n = fb.sampleCount(row, col);
+            total += n;
+            double t = clamp((n - scene.minSamples) / range, 0.0, 1.0);
+            color c = t < 0.5 ? color(0, 2 * t, 1 - 2 * t) : color(2 * t - 1, 2 - 2 * t, 0);
+            heat.addSample(row, col, c);
+        }
+    }
+    
+    cerr << "Média de amostras por pixel: " << double(total) / (double(scene.imgWidth) * scene.imgHeight) << endl;
+    
+    if(!scene.heatmapFile.empty()) {
+        unique_ptr<ImageWriter> writer = ImageWriter::create(ImageFormat::PPM_BINARY);
+        if(!writer->open(scene.heatmapFile, scene.imgWidth, scene.imgHeight)) return false;
+        writer->writeRows(heat, 0, scene.imgHeight - 1);
+        if(!writer->close()) {
+            cerr << "Erro: Não foi possível gravar o arquivo " << scene.heatmapFile << endl;
+            return false;
+        }
+        cerr << "Mapa de amostras salvo em: " << scene.heatmapFile << endl;
     }
+    return true;
 }
 
-void Renderer::printRemaining() {
-    cerr << "\rLinhas restantes: " << remainingRows << ' ' << flush;
+void Renderer::printRemaining(int remainingTiles) {
+    cerr << "\rBlocos restantes: " << remainingTiles << ' ' << flush;
 }
@@ -0,0 +1,301 @@
+#include "scene_file.hpp"
+#include "objects/sphere.hpp"
+#include "objects/polyhedron.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <type_traits>
+
+using namespace std;
+
+const char SceneFile::magic[8] = {'R', 'T', 'S', 'C', 'E', 'N', 'E', '\n'};
+
+namespace {
+    enum Section { Lights, Pigments, Materials, Objects, Faces, Names, BVHNodes, BVHOrder, SectionCount };
+
+    struct SectionEntry {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t sectionCount;
+        uint64_t fileSize;
+        CameraRecord camera;
+        SectionEntry sections[SectionCount];
+    };
+
+    const size_t sectionAlignment = 8;
+
+    static_assert(is_trivially_copyable<Header>::value && is_trivially_copyable<PigmentRecord>::value &&
+                  is_trivially_copyable<ObjectRecord>::value && is_trivially_copyable<BVHBakedNode>::value,
+                  "os registros são gravados e lidos byte a byte");
+
+    template<typename T>
+    RecordSpan<T> span(const vector<T>& v) {
+        return RecordSpan<T>{v.data(), v.size()};
+    }
+
+    // Aponta out para a seção, se ela couber no arquivo com o alinhamento esperado
+    template<typename T>
+    bool mapSection(string_view contents, const SectionEntry& entry, RecordSpan<T>& out) {
+        if(entry.offset % sectionAlignment != 0 || entry.offset > contents.size()) return false;
+        if(entry.count > (contents.size() - entry.offset) / sizeof(T)) return false;
+        out.data = (const T*)(contents.data() + entry.offset);
+        out.count = entry.count;
+        return true;
+    }
+
+    vec4 toVec4(const double v[4]) {
+        return vec4(v[0], v[1], v[2], v[3]);
+    }
+
+    // Acrescenta size bytes ao hash FNV-1a h
+    uint64_t fnv1a(const void* data, size_t size, uint64_t h) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for(size_t i = 0; i < size; i++) {
+            h = (h ^ bytes[i]) * 0x100000001b3ull;
+        }
+        return h;
+    }
+
+    // Quantidade e conteúdo da seção (a quantidade separa seções vizinhas)
+    template<typename T>
+    uint64_t hashSection(const RecordSpan<T>& records, uint64_t h) {
+        uint64_t count = records.size();
+        h = fnv1a(&count, sizeof(count), h);
+        return fnv1a(records.data, records.size() * sizeof(T), h);
+    }
+}
+
+SceneView SceneData::view() const {
+    SceneView v;
+    v.camera = camera;
+    v.lights = span(lights);
+    v.pigments = span(pigments);
+    v.materials = span(materials);
+    v.objects = span(objects);
+    v.faces = span(faces);
+    v.names = names;
+    return v;
+}
+
+bool SceneFile::isBinary(string_view contents) {
+    return contents.size() >= sizeof(magic) && memcmp(contents.data(), magic, sizeof(magic)) == 0;
+}
+
+bool SceneFile::read(string_view contents, SceneView& view) {
+    Header h;
+    if(contents.size() < sizeof(h) || !isBinary(contents)) {
+        cerr << "Erro: não é um arquivo de cena binário" << endl;
+        return false;
+    }
+    memcpy(&h, contents.data(), sizeof(h));
+    if(h.version != version || h.sectionCount != SectionCount) {
+        cerr << "Erro: arquivo de cena binário da versão " << h.version << ", esperada a versão " << version << endl;
+        return false;
+    }
+    if(h.fileSize != contents.size()) {
+        cerr << "Erro: arquivo de cena binário incompleto (" << contents.size() << " de " << h.fileSize << " bytes)" << endl;
+        return false;
+    }
+
+    view = SceneView();
+    view.camera = h.camera;
+    RecordSpan<char> names;
+    if(!mapSection(contents, h.sections[Lights], view.lights) ||
+       !mapSection(contents, h.sections[Pigments], view.pigments) ||
+       !mapSection(contents, h.sections[Materials], view.materials) ||
+       !mapSection(contents, h.sections[Objects], view.objects) ||
+       !mapSection(contents, h.sections[Faces], view.faces) ||
+       !mapSection(contents, h.sections[Names], names) ||
+       !mapSection(contents, h.sections[BVHNodes], view.bvhNodes) ||
+       !mapSection(contents, h.sections[BVHOrder], view.bvhOrder)) {
+        cerr << "Erro: seção fora dos limites do arquivo de cena binário" << endl;
+        return false;
+    }
+    view.names = string_view(names.data, names.count);
+
+    for(const PigmentRecord& p : view.pigments) {
+        if(p.type != PigmentType::Solid && p.type != PigmentType::Checker && p.type != PigmentType::Image) {
+            cerr << "Erro: tipo de pigmento desconhecido no arquivo de cena binário" << endl;
+            return false;
+        }
+        if(p.type == PigmentType::Image && (uint64_t)p.nameOffset + p.nameLength > view.names.size()) {
+            cerr << "Erro: nome de textura fora dos limites do arquivo de cena binário" << endl;
+            return false;
+        }
+    }
+
+    for(const ObjectRecord& o : view.objects) {
+        if(o.type != ObjectType::Sphere && o.type != ObjectType::Polyhedron) {
+            cerr << "Erro: tipo de objeto desconhecido no arquivo de cena binário" << endl;
+            return false;
+        }
+        if(o.pigment < 0 || (size_t)o.pigment >= view.pigments.size() ||
+           o.material < 0 || (size_t)o.material >= view.materials.size()) {
+            cerr << "Erro: objeto com pigmento ou material inexistente no arquivo de cena binário" << endl;
+            return false;
+        }
+        if(o.type == ObjectType::Polyhedron && (uint64_t)o.faceFirst + o.faceCount > view.faces.size()) {
+            cerr << "Erro: faces fora dos limites do arquivo de cena binário" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SceneFile::write(const string& path, const SceneData& data, const ComponentList* bvh) {
+    vector<BVHBakedNode> nodes;
+    vector<uint32_t> order;
+    if(bvh && bvh->isBuilt()) bvh->bake(nodes, order);
+
+    Header h{};
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.sectionCount = SectionCount;
+    h.camera = data.camera;
+
+    const void* payload[SectionCount] = {
+        data.lights.data(), data.pigments.data(), data.materials.data(), data.objects.data(),
+        data.faces.data(), data.names.data(), nodes.data(), order.data()
+    };
+    size_t counts[SectionCount] = {
+        data.lights.size(), data.pigments.size(), data.materials.size(), data.objects.size(),
+        data.faces.size(), data.names.size(), nodes.size(), order.size()
+    };
+    size_t recordSizes[SectionCount] = {
+        sizeof(LightRecord), sizeof(PigmentRecord), sizeof(MaterialRecord), sizeof(ObjectRecord),
+        sizeof(FaceRecord), 1, sizeof(BVHBakedNode), sizeof(uint32_t)
+    };
+
+    uint64_t offset = sizeof(h);
+    for(int s = 0; s < SectionCount; s++) {
+        offset = (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+        h.sections[s].offset = offset;
+        h.sections[s].count = counts[s];
+        offset += counts[s] * recordSizes[s];
+    }
+    h.fileSize = offset;
+
+    ofstream file(path, ios::out | ios::binary | ios::trunc);
+    if(!file.is_open()) {
+        cerr << "Erro: Não foi possível criar o arquivo " << path << endl;
+        return false;
+    }
+
+    const char padding[sectionAlignment] = {0};
+    file.write((const char*)&h, sizeof(h));
+    uint64_t written = sizeof(h);
+    for(int s = 0; s < SectionCount; s++) {
+        file.write(padding, h.sections[s].offset - written);
+        file.write((const char*)payload[s], counts[s] * recordSizes[s]);
+        written = h.sections[s].offset + counts[s] * recordSizes[s];
+    }
+    if(!file) {
+        cerr << "Erro: Falha ao gravar o arquivo de cena " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::applyCamera(const CameraRecord& camera, SceneDescription& scene) {
+    scene.lookFrom = p3(camera.lookFrom[0], camera.lookFrom[1], camera.lookFrom[2]);
+    scene.lookAt = p3(camera.lookAt[0], camera.lookAt[1], camera.lookAt[2]);
+    scene.vUp = p3(camera.vUp[0], camera.vUp[1], camera.vUp[2]);
+    scene.vFov = camera.vFov;
+    scene.aperture = camera.aperture;
+    scene.distToFocus = camera.distToFocus;
+}
+
+CameraRecord SceneFile::camera(const SceneDescription& scene) {
+    CameraRecord camera;
+    for(int k = 0; k < 3; k++) {
+        camera.lookFrom[k] = scene.lookFrom[k];
+        camera.lookAt[k] = scene.lookAt[k];
+        camera.vUp[k] = scene.vUp[k];
+    }
+    camera.vFov = scene.vFov;
+    camera.aperture = scene.aperture;
+    camera.distToFocus = scene.distToFocus;
+    return camera;
+}
+
+uint64_t SceneFile::hash(const SceneView& view) {
+    uint64_t h = fnv1a(&view.camera, sizeof(view.camera), 0xcbf29ce484222325ull);
+    h = hashSection(view.lights, h);
+    h = hashSection(view.pigments, h);
+    h = hashSection(view.materials, h);
+    h = hashSection(view.objects, h);
+    h = hashSection(view.faces, h);
+    h = hashSection(RecordSpan<char>{view.names.data(), view.names.size()}, h);
+    return h;
+}
+
+void SceneFile::instantiate(const SceneView& view, SceneDescription& scene) {
+    applyCamera(view.camera, scene);
+    scene.sceneHash = hash(view);
+
+    for(const LightRecord& l : view.lights) {
+        LightMaterialPtr lightMaterial = make_shared<LightMaterial>(
+            color(l.color[0], l.color[1], l.color[2]), l.attenuation[0], l.attenuation[1], l.attenuation[2], true
+        );
+        scene.lights.push_back(Light(p3(l.position[0], l.position[1], l.position[2]), lightMaterial));
+    }
+
+    for(const PigmentRecord& p : view.pigments) {
+        color c1(p.color1[0], p.color1[1], p.color1[2]);
+        if(p.type == PigmentType::Solid) {
+            scene.pigments.push_back(make_shared<SolidColor>(c1));
+        } else if(p.type == PigmentType::Checker) {
+            CheckerTexturePtr checker = make_shared<CheckerTexture>(c1, color(p.color2[0], p.color2[1], p.color2[2]));
+            checker->setSize(p.size);
+            scene.pigments.push_back(checker);
+        } else {
+            string image(view.names.substr(p.nameOffset, p.nameLength));
+            scene.pigments.push_back(make_shared<ImageTexturePs>(image.c_str(), toVec4(p.p0), toVec4(p.p1)));
+        }
+    }
+
+    for(const MaterialRecord& m : view.materials) {
+        scene.materials.push_back(make_shared<GenericMaterial>(m.ka, m.kd, m.ks, m.alpha, m.kr, m.kt, m.ior, m.fuzz));
+    }
+
+    // Um material por combinação (material, pigmento), compartilhado pelos objetos que a usam
+    map<pair<int, int>, const Material*> combined;
+    scene.componentList.objects.reserve(view.objects.size());
+    for(const ObjectRecord& o : view.objects) {
+        pair<int, int> key = make_pair(o.material, o.pigment);
+        auto it = combined.find(key);
+        if(it == combined.end()) {
+            GenericMaterial mat = *scene.materials[o.material];
+            mat.col = scene.pigments[o.pigment];
+            scene.objectMaterials.push_back(make_shared<GenericMaterial>(mat));
+            it = combined.emplace(key, scene.objectMaterials.back().get()).first;
+        }
+        const Material* matPtr = it->second;
+
+        if(o.type == ObjectType::Sphere) {
+            p3 center(o.sphere[0], o.sphere[1], o.sphere[2]);
+            scene.componentList.add(make_shared<Sphere>(center, o.sphere[3], matPtr));
+        } else {
+            PolyhedronPtr poly = make_shared<Polyhedron>(matPtr);
+            poly->faces.reserve(o.faceCount);
+            for(uint32_t j = o.faceFirst; j < o.faceFirst + o.faceCount; j++) {
+                const FaceRecord& f = view.faces[j];
+                poly->addFace(Plane(f.a, f.b, f.c, f.d));
+            }
+            scene.componentList.add(poly);
+        }
+    }
+
+    // Constrói a estrutura de aceleração depois que todos os objetos foram criados
+    if(!view.bvhNodes.size()) {
+        scene.componentList.build();
+    } else if(!scene.componentList.build(view.bvhNodes.data, view.bvhNodes.size(), view.bvhOrder.data, view.bvhOrder.size())) {
+        cerr << "Aviso: a BVH gravada no arquivo de cena não corresponde aos objetos; construída de novo" << endl;
+    }
+}
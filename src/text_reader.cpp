@@ -0,0 +1,99 @@
+#include "text_reader.hpp"
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+bool MappedFile::open(const string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Arquivo vazio: não há o que mapear
+    length = st.st_size;
+    if(length > 0) {
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(p, length, MADV_SEQUENTIAL);
+        data = (const char*)p;
+    }
+
+    // O mapeamento continua válido depois de fechar o descritor
+    ::close(fd);
+    return true;
+}
+
+void MappedFile::close() {
+    if(data) munmap((void*)data, length);
+    data = nullptr;
+    length = 0;
+}
+
+bool TextReader::nextLine() {
+    if(next >= end) return false;
+    cur = next;
+    const char* newline = (const char*)memchr(cur, '\n', end - cur);
+    lineEnd = newline ? newline : end;
+    next = newline ? newline + 1 : end;
+    line++;
+    return true;
+}
+
+void TextReader::skipSpaces() {
+    while(cur < lineEnd && (*cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\v' || *cur == '\f')) cur++;
+}
+
+bool TextReader::hasMore() {
+    skipSpaces();
+    return cur < lineEnd;
+}
+
+string_view TextReader::word() {
+    skipSpaces();
+    const char* start = cur;
+    while(cur < lineEnd && !(*cur == ' ' || *cur == '\t' || *cur == '\r' || *cur == '\v' || *cur == '\f')) cur++;
+    return string_view(start, cur - start);
+}
+
+double TextReader::number() {
+    string_view token = word();
+    // from_chars não aceita o sinal '+' que stod aceita
+    const char* first = token.data();
+    if(!token.empty() && *first == '+') first++;
+    double value;
+    auto result = from_chars(first, token.data() + token.size(), value);
+    if(result.ec != errc() || token.empty()) fail("número", token);
+    return value;
+}
+
+int TextReader::integer() {
+    string_view token = word();
+    const char* first = token.data();
+    if(!token.empty() && *first == '+') first++;
+    int value;
+    auto result = from_chars(first, token.data() + token.size(), value);
+    if(result.ec != errc() || token.empty()) fail("número inteiro", token);
+    return value;
+}
+
+void TextReader::fail(const char* expected, string_view found) const {
+    string message = "linha " + to_string(line) + ": " + expected + " esperado";
+    message += found.empty() ? string(", fim da linha encontrado") : ", encontrado \"" + string(found) + "\"";
+    throw runtime_error(message);
+}
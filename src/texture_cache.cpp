@@ -0,0 +1,162 @@
+#include "texture_cache.hpp"
+#include "v_stb_image.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+
+using namespace std;
+
+TextureFilter TextureCache::currentFilter = TextureFilter::Trilinear;
+TextureLayout TextureCache::currentLayout = TextureLayout::Linear;
+mutex TextureCache::mutex;
+unordered_map<string, TextureImagePtr> TextureCache::images;
+
+TextureImage::TextureImage(const unsigned char* data, int width, int height, TextureLayout layout) {
+    Level base{width, height, 0, vector<float>(size_t(width) * height * 3)};
+    for(size_t i = 0; i < base.texels.size(); i++) {
+        base.texels[i] = data[i] / 255.0f;
+    }
+    levels.push_back(move(base));
+
+    // Each level averages 2x2 blocks of the previous one (the last row/column of odd sizes is folded
+    // into the block before it), down to 1x1
+    while(levels.back().width > 1 || levels.back().height > 1) {
+        const Level& src = levels.back();
+        Level dst{max(src.width / 2, 1), max(src.height / 2, 1), 0, {}};
+        dst.texels.resize(size_t(dst.width) * dst.height * 3);
+        for(int y = 0; y < dst.height; y++) {
+            int y0 = min(2 * y, src.height - 1), y1 = min(2 * y + 1, src.height - 1);
+            for(int x = 0; x < dst.width; x++) {
+                int x0 = min(2 * x, src.width - 1), x1 = min(2 * x + 1, src.width - 1);
+                float* out = &dst.texels[3 * (size_t(y) * dst.width + x)];
+                for(int k = 0; k < 3; k++) {
+                    out[k] = 0.25f * (src.texel(x0, y0)[k] + src.texel(x1, y0)[k] +
+                                      src.texel(x0, y1)[k] + src.texel(x1, y1)[k]);
+                }
+            }
+        }
+        levels.push_back(move(dst));
+    }
+
+    // The pyramid is built row-major and converted level by level
+    if(layout == TextureLayout::Tiled) {
+        for(Level& l : levels) {
+            l = tiled(l);
+        }
+    }
+}
+
+TextureImage::Level TextureImage::tiled(const Level& linear) {
+    // Partial tiles on the right and bottom borders are padded to full tiles
+    const int tileSize = 1 << tileShift;
+    int tilesPerRow = (linear.width + tileSize - 1) / tileSize;
+    int tileRows = (linear.height + tileSize - 1) / tileSize;
+
+    Level l{linear.width, linear.height, tilesPerRow, {}};
+    l.texels.assign(size_t(tilesPerRow) * tileRows * tileSize * tileSize * 3, 0.0f);
+    for(int y = 0; y < l.height; y++) {
+        for(int x = 0; x < l.width; x++) {
+            const float* src = linear.texel(x, y);
+            float* dst = &l.texels[3 * l.offset(x, y)];
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+    return l;
+}
+
+size_t TextureImage::bytes() const {
+    size_t total = 0;
+    for(const Level& l : levels) {
+        total += l.texels.size() * sizeof(float);
+    }
+    return total;
+}
+
+color TextureImage::bilinear(const Level& l, double u, double v) const {
+    // Texel centers at (i + 0.5) / width; clamps at the borders
+    double x = u * l.width - 0.5;
+    double y = v * l.height - 0.5;
+    int x0 = (int)floor(x), y0 = (int)floor(y);
+    double fx = x - x0, fy = y - y0;
+    int x1 = min(max(x0 + 1, 0), l.width - 1), y1 = min(max(y0 + 1, 0), l.height - 1);
+    x0 = min(max(x0, 0), l.width - 1);
+    y0 = min(max(y0, 0), l.height - 1);
+
+    const float* a = l.texel(x0, y0);
+    const float* b = l.texel(x1, y0);
+    const float* c = l.texel(x0, y1);
+    const float* d = l.texel(x1, y1);
+    double result[3];
+    for(int k = 0; k < 3; k++) {
+        double top = a[k] + fx * (b[k] - a[k]);
+        double bottom = c[k] + fx * (d[k] - c[k]);
+        result[k] = top + fy * (bottom - top);
+    }
+    return color(result[0], result[1], result[2]);
+}
+
+color TextureImage::sample(double u, double v, double footprint, TextureFilter filter) const {
+    if(filter == TextureFilter::Nearest) {
+        const Level& l = levels[0];
+        int i = min((int)(u * l.width), l.width - 1);
+        int j = min((int)(v * l.height), l.height - 1);
+        const float* t = l.texel(max(i, 0), max(j, 0));
+        return color(t[0], t[1], t[2]);
+    }
+
+    // Level whose texels are about as wide as the footprint
+    double lod = footprint > 1 ? log2(footprint) : 0;
+    int last = levels.size() - 1;
+    if(lod >= last) return bilinear(levels[last], u, v);
+    int l0 = (int)lod;
+    double f = lod - l0;
+    color c0 = bilinear(levels[l0], u, v);
+    if(f == 0) return c0;
+    return c0 + f * (bilinear(levels[l0 + 1], u, v) - c0);
+}
+
+TextureImagePtr TextureCache::load(const string& path) {
+    // The same file may be named with different relative paths
+    error_code ec;
+    string key = filesystem::weakly_canonical(path, ec).string();
+    if(ec) key = path;
+
+    lock_guard<std::mutex> lock(mutex);
+    auto it = images.find(key);
+    if(it != images.end()) return it->second;
+
+    int width, height, componentsPerPixel;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &componentsPerPixel, 3); // sempre RGB
+    if(!data) {
+        cerr << "Could not load texture file " << path << endl;
+        return nullptr;
+    }
+    cout << path << ": " << width << " " << height << endl;
+
+    TextureImagePtr image = make_shared<const TextureImage>(data, width, height, currentLayout);
+    stbi_image_free(data);
+    images[key] = image;
+    return image;
+}
+
+size_t TextureCache::imageCount() {
+    lock_guard<std::mutex> lock(mutex);
+    return images.size();
+}
+
+size_t TextureCache::memoryUsage() {
+    lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for(const auto& entry : images) {
+        total += entry.second->bytes();
+    }
+    return total;
+}
+
+void TextureCache::clear() {
+    lock_guard<std::mutex> lock(mutex);
+    images.clear();
+}
@@ -0,0 +1,108 @@
+#include "thread_pool.hpp"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threadCount) {
+    if(threadCount <= 0) {
+        threadCount = thread::hardware_concurrency();
+        if(threadCount <= 0) threadCount = 1;
+    }
+
+    for(int i = 0; i < threadCount; i++) {
+        queues.push_back(make_unique<Queue>());
+    }
+    for(int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto& w : workers) {
+        w.join();
+    }
+}
+
+void ThreadPool::run(const vector<function<void()>>& tasks) {
+    if(tasks.empty()) return;
+
+    Batch batch;
+    batch.remaining = tasks.size();
+
+    // Distribui as tarefas em blocos contíguos: cada thread começa por uma região vizinha da
+    // imagem e só rouba de outras quando a sua acaba
+    int n = queues.size();
+    size_t perQueue = (tasks.size() + n - 1) / n;
+    for(int q = 0; q < n; q++) {
+        lock_guard<mutex> lock(queues[q]->mutex);
+        for(size_t i = q * perQueue; i < tasks.size() && i < (q + 1) * perQueue; i++) {
+            queues[q]->tasks.push_back(Task{tasks[i], &batch});
+        }
+    }
+
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        pending += tasks.size();
+    }
+    wake.notify_all();
+
+    unique_lock<mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&]() { return batch.remaining == 0; });
+}
+
+bool ThreadPool::pop(int index, Task& task) {
+    lock_guard<mutex> lock(queues[index]->mutex);
+    if(queues[index]->tasks.empty()) return false;
+    task = move(queues[index]->tasks.front());
+    queues[index]->tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(int thief, Task& task) {
+    int n = queues.size();
+    for(int k = 1; k < n; k++) {
+        Queue& victim = *queues[(thief + k) % n];
+        lock_guard<mutex> lock(victim.mutex);
+        if(!victim.tasks.empty()) {
+            task = move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index) {
+    while(true) {
+        {
+            unique_lock<mutex> lock(sleepMutex);
+            wake.wait(lock, [&]() { return stopping || pending > 0; });
+            if(stopping && pending == 0) return;
+        }
+
+        Task task;
+        if(!pop(index, task) && !steal(index, task)) {
+            // Outra thread pegou a tarefa entre o aviso e a busca
+            continue;
+        }
+
+        {
+            lock_guard<mutex> lock(sleepMutex);
+            pending--;
+        }
+
+        task.fn();
+
+        // Avisa quem está esperando pelo lote quando a última tarefa termina. O decremento é feito
+        // sob o mutex do lote para que run() não retorne (destruindo o lote) antes do aviso.
+        Batch* batch = task.batch;
+        lock_guard<mutex> lock(batch->mutex);
+        if(--batch->remaining == 0) {
+            batch->done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+// Converte uma cena do formato texto para o formato binário de SceneFile (.rtscene), que o programa
+// principal carrega direto do arquivo mapeado em memória. Por padrão a BVH é construída aqui e a sua
+// topologia vai junto no arquivo, para que a renderização não precise construí-la de novo.
+//
+// Uso: ./scene_convert <entrada.txt> <saida.rtscene> [--no-bvh]
+//
+// Com um erro na entrada nada é gravado, e um arquivo de saída de uma conversão anterior é apagado para
+// não ser confundido com a conversão da entrada atual.
+
+#include "input_processor.hpp"
+#include "scene_file.hpp"
+#include "text_reader.hpp"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Apaga a saída (de uma conversão anterior ou gravada pela metade) e retorna o código de erro
+static int fail(const string& output) {
+    error_code ec;
+    filesystem::remove(output, ec);
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        cerr << "Uso: " << argv[0] << " <entrada.txt> <saida.rtscene> [--no-bvh]" << endl;
+        return -1;
+    }
+    string input = argv[1], output = argv[2];
+    bool bakeBVH = !(argc >= 4 && string(argv[3]) == "--no-bvh");
+
+    MappedFile file;
+    if(!file.open(input)) {
+        cerr << "Erro: Não foi possível abrir o arquivo " << input << endl;
+        return -1;
+    }
+    if(SceneFile::isBinary(file.contents())) {
+        cerr << "Erro: " << input << " já está no formato binário" << endl;
+        return -1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    SceneData data;
+    if(!InputProcessor::parseFile(file.contents(), input, data)) {
+        return fail(output);
+    }
+
+    // A topologia gravada é a da BVH que a cena de texto construiria
+    SceneDescription scene;
+    if(bakeBVH) SceneFile::instantiate(data.view(), scene);
+
+    if(!SceneFile::write(output, data, bakeBVH ? &scene.componentList : nullptr)) {
+        return fail(output);
+    }
+    auto end = chrono::steady_clock::now();
+
+    cerr << output << ": " << data.objects.size() << " objetos, " << data.lights.size() << " luzes, "
+         << data.pigments.size() << " pigmentos, " << data.materials.size() << " materiais"
+         << (bakeBVH ? ", com BVH" : "") << " (" << chrono::duration<double>(end - start).count() << " s)" << endl;
+    return 0;
+}